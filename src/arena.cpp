@@ -0,0 +1,69 @@
+#include "includes/arena.hpp"
+#include <cstdlib>
+#include <algorithm>
+
+// chunks double in size up to this, larger requests get a chunk of their own
+static const size_t maxChunkSize = 4 * 1024 * 1024;
+
+void* Arena::grow(size_t size, size_t align)
+{
+    size_t chunkSize = std::max(this->nextChunkSize, size + align);
+    char* chunk = (char*)std::malloc(chunkSize);
+    if (chunk == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    this->chunks.push_back(chunk);
+    this->cursor = chunk;
+    this->limit = chunk + chunkSize;
+    this->nextChunkSize = std::min(this->nextChunkSize * 2, maxChunkSize);
+    return this->allocate(size, align);
+}
+
+Arena::Arena(Arena&& other) : chunks(std::move(other.chunks)), cursor(other.cursor), limit(other.limit), nextChunkSize(other.nextChunkSize), used(other.used)
+{
+    other.chunks.clear();
+    other.cursor = nullptr;
+    other.limit = nullptr;
+    other.used = 0;
+}
+
+Arena& Arena::operator=(Arena&& other)
+{
+    if (this != &other)
+    {
+        for (char* chunk : this->chunks)
+        {
+            std::free(chunk);
+        }
+        this->chunks = std::move(other.chunks);
+        this->cursor = other.cursor;
+        this->limit = other.limit;
+        this->nextChunkSize = other.nextChunkSize;
+        this->used = other.used;
+        other.chunks.clear();
+        other.cursor = nullptr;
+        other.limit = nullptr;
+        other.used = 0;
+    }
+    return *this;
+}
+
+Arena::~Arena()
+{
+    for (char* chunk : this->chunks)
+    {
+        std::free(chunk);
+    }
+}
+
+void Arena::adopt(Arena&& other)
+{
+    // allocation carries on in our current chunk, the adopted ones are only kept alive
+    this->chunks.insert(this->chunks.end(), other.chunks.begin(), other.chunks.end());
+    this->used += other.used;
+    other.chunks.clear();
+    other.cursor = nullptr;
+    other.limit = nullptr;
+    other.used = 0;
+}
@@ -1,3 +1,9 @@
 #include "includes/ast.hpp"
+#include "includes/visitor.hpp"
 
-// here goes codegen
\ No newline at end of file
+// here goes codegen
+
+void Node::children(std::vector<Node*>& out)
+{
+    eachChild(this, [&](Node* child) { out.push_back(child); });
+}
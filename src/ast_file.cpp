@@ -0,0 +1,249 @@
+#include "includes/ast_file.hpp"
+#include <atomic>
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+const char ast_file_magic[8] = {'M', 'U', 'S', 'E', 'A', 'S', 'T', '\0'};
+const uint32_t ast_file_byte_order = 0x01020304;
+
+// offsets of each section, derived from the header's counts
+struct AstFileLayout
+{
+    size_t kinds, spans, childRanges, payloads, children, numbers, strings, stringData, end;
+};
+
+static size_t align8(size_t offset)
+{
+    return (offset + 7) & ~(size_t)7;
+}
+
+static AstFileLayout layout(const AstFileHeader& header)
+{
+    AstFileLayout at;
+    at.kinds = align8(sizeof(AstFileHeader));
+    at.spans = align8(at.kinds + (size_t)header.nodeCount * sizeof(NodeKind));
+    at.childRanges = align8(at.spans + (size_t)header.nodeCount * sizeof(Span));
+    at.payloads = align8(at.childRanges + (size_t)header.nodeCount * sizeof(FlatAst::Range));
+    at.children = align8(at.payloads + (size_t)header.nodeCount * sizeof(FlatAst::Range));
+    at.numbers = align8(at.children + (size_t)header.childCount * sizeof(uint32_t));
+    at.strings = align8(at.numbers + (size_t)header.numberCount * sizeof(double));
+    at.stringData = align8(at.strings + (size_t)header.stringCount * sizeof(FlatAst::Range));
+    at.end = at.stringData + header.stringBytes;
+    return at;
+}
+
+void writeAstFile(const FlatAst& ast, const std::string& path)
+{
+    AstFileHeader header = {};
+    std::memcpy(header.magic, ast_file_magic, sizeof(header.magic));
+    header.version = ast_file_version;
+    header.byteOrder = ast_file_byte_order;
+    header.nodeCount = ast.kinds.size();
+    header.childCount = ast.children.size();
+    header.numberCount = ast.numbers.size();
+    header.stringCount = ast.strings.size();
+    header.stringBytes = ast.stringData.size();
+
+    AstFileLayout at = layout(header);
+    std::string bytes(at.end, '\0');
+    auto put = [&](size_t offset, const void* items, size_t size)
+    {
+        if (size > 0)
+        {
+            std::memcpy(&bytes[offset], items, size);
+        }
+    };
+    put(0, &header, sizeof(header));
+    put(at.kinds, ast.kinds.data(), ast.kinds.size() * sizeof(NodeKind));
+    put(at.spans, ast.spans.data(), ast.spans.size() * sizeof(Span));
+    put(at.childRanges, ast.childRanges.data(), ast.childRanges.size() * sizeof(FlatAst::Range));
+    put(at.payloads, ast.payloads.data(), ast.payloads.size() * sizeof(FlatAst::Range));
+    put(at.children, ast.children.data(), ast.children.size() * sizeof(uint32_t));
+    put(at.numbers, ast.numbers.data(), ast.numbers.size() * sizeof(double));
+    put(at.strings, ast.strings.data(), ast.strings.size() * sizeof(FlatAst::Range));
+    put(at.stringData, ast.stringData.data(), ast.stringData.size());
+
+    // unique per writer, several may be storing the same path at once
+    static std::atomic<unsigned> writes(0);
+    std::string temporary = path + "." + std::to_string(getpid()) + "." + std::to_string(writes++) + ".tmp";
+    int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        throw std::runtime_error("Could not write " + path + ": " + std::strerror(errno));
+    }
+    size_t written = 0;
+    while (written < bytes.size())
+    {
+        ssize_t n = write(fd, bytes.data() + written, bytes.size() - written);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n < 0)
+        {
+            std::string error = std::strerror(errno);
+            close(fd);
+            unlink(temporary.c_str());
+            throw std::runtime_error("Could not write " + path + ": " + error);
+        }
+        written += n;
+    }
+    close(fd);
+    if (rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        std::string error = std::strerror(errno);
+        unlink(temporary.c_str());
+        throw std::runtime_error("Could not write " + path + ": " + error);
+    }
+}
+
+// every index the encoding in flat_ast.hpp allows a node to follow must land
+// inside its table, and children must come after their parent so a traversal
+// always terminates
+static bool valid(const AstView& ast, const AstFileHeader& header)
+{
+    for (uint32_t i = 0; i < header.stringCount; i++)
+    {
+        if ((uint64_t)ast.strings[i].first + ast.strings[i].count > header.stringBytes)
+        {
+            return false;
+        }
+    }
+    for (uint32_t node = 0; node < ast.size(); node++)
+    {
+        if (ast.kind(node) > NodeKind::FunctionCall)
+        {
+            return false;
+        }
+        FlatAst::Range children = ast.childRanges[node];
+        if ((uint64_t)children.first + children.count > header.childCount)
+        {
+            return false;
+        }
+        for (uint32_t child : ast.childrenOf(node))
+        {
+            if (child <= node || child >= ast.size())
+            {
+                return false;
+            }
+        }
+
+        uint32_t minimum = 0, exact = UINT32_MAX, strings = 0, numbers = 0;
+        FlatAst::Range payload = ast.payload(node);
+        switch (ast.kind(node))
+        {
+            case NodeKind::Parameter: exact = 0; strings = 2; break;
+            case NodeKind::FunctionPrototype: strings = 2; break;
+            case NodeKind::FunctionDefenition: exact = 2; break;
+            case NodeKind::ReturnStatement: exact = 1; break;
+            case NodeKind::ForLoop: minimum = 2; break;
+            case NodeKind::WhileLoop: exact = 2; break;
+            case NodeKind::Assignment: exact = 1; strings = 2; break;
+            case NodeKind::IfStatement: exact = 3; break;
+            case NodeKind::Identifier: exact = 0; strings = 1; break;
+            case NodeKind::NumericLiteral: exact = 0; numbers = 1; break;
+            case NodeKind::StringLiteral: exact = 0; strings = 1; break;
+            case NodeKind::Subscription: exact = 2; break;
+            case NodeKind::AttributeReference: exact = 2; break;
+            case NodeKind::Slice: exact = 3; break;
+            case NodeKind::List: exact = 0; strings = payload.count; break;
+            case NodeKind::Set: exact = 0; numbers = payload.count < 1 ? 1 : payload.count; break;
+            case NodeKind::Generator: exact = 3; break;
+            case NodeKind::BinaryExpression: exact = 2; strings = 1; break;
+            case NodeKind::ListComprehension: minimum = 3; break;
+            case NodeKind::FunctionCall: strings = 1; break;
+            default: break;
+        }
+        if (children.count < minimum || (exact != UINT32_MAX && children.count != exact))
+        {
+            return false;
+        }
+        if (strings > 0 && (payload.count != strings || (uint64_t)payload.first + strings > header.stringCount))
+        {
+            return false;
+        }
+        if (numbers > 0 && (payload.count != numbers || (uint64_t)payload.first + numbers > header.numberCount))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+AstFile AstFile::open(const std::string& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error("Could not open " + path + ": " + std::strerror(errno));
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(AstFileHeader))
+    {
+        close(fd);
+        throw std::runtime_error(path + " is not a muse AST file");
+    }
+
+    AstFile file;
+    void* mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        throw std::runtime_error("Could not map " + path + ": " + std::strerror(errno));
+    }
+    file.data = static_cast<const char*>(mapping);
+    file.size = info.st_size;
+
+    AstFileHeader header;
+    std::memcpy(&header, file.data, sizeof(header));
+    if (std::memcmp(header.magic, ast_file_magic, sizeof(header.magic)) != 0)
+    {
+        throw std::runtime_error(path + " is not a muse AST file");
+    }
+    if (header.version != ast_file_version || header.byteOrder != ast_file_byte_order)
+    {
+        throw std::runtime_error(path + " was written by an incompatible version of muse");
+    }
+    AstFileLayout at = layout(header);
+    if (at.end != file.size || header.nodeCount == 0)
+    {
+        throw std::runtime_error(path + " is truncated or corrupt");
+    }
+
+    file.ast = {
+        header.nodeCount,
+        reinterpret_cast<const NodeKind*>(file.data + at.kinds),
+        reinterpret_cast<const Span*>(file.data + at.spans),
+        reinterpret_cast<const FlatAst::Range*>(file.data + at.childRanges),
+        reinterpret_cast<const FlatAst::Range*>(file.data + at.payloads),
+        reinterpret_cast<const uint32_t*>(file.data + at.children),
+        reinterpret_cast<const double*>(file.data + at.numbers),
+        reinterpret_cast<const FlatAst::Range*>(file.data + at.strings),
+        file.data + at.stringData,
+    };
+    if (!valid(file.ast, header))
+    {
+        throw std::runtime_error(path + " is truncated or corrupt");
+    }
+    return file;
+}
+
+AstFile::AstFile(AstFile&& other) : data(other.data), size(other.size), ast(other.ast)
+{
+    other.data = nullptr;
+    other.size = 0;
+}
+
+AstFile::~AstFile()
+{
+    if (this->data != nullptr)
+    {
+        munmap(const_cast<char*>(this->data), this->size);
+    }
+}
@@ -0,0 +1,313 @@
+// Deterministic synthetic muse sources for the benchmarks. The same shape,
+// size and seed always give the same bytes on every platform, so timings
+// taken on different commits are timings of the same input.
+
+#pragma once
+
+#ifndef BENCH_CORPUS_HPP
+#define BENCH_CORPUS_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+const char* const corpus_shapes[] = {"typical", "deep", "expressions", "comprehensions", "wide"};
+
+class Corpus
+{
+    // splitmix64, rather than <random>, whose distributions differ between libraries
+    uint64_t state;
+    std::string out;
+    std::string_view shape;
+
+    uint64_t next()
+    {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    int below(int n) { return next() % n; }
+
+    bool wide() const { return shape == "wide"; }
+
+    // letters only, the lexer takes no digits in names
+    void name()
+    {
+        static const char* syllables[] = {"ka", "lo", "mi", "ne", "ru", "sa", "ti", "vo", "ze", "po", "da", "fu"};
+        int count = wide() ? 6 + below(8) : 2 + below(2);
+        for (int i = 0; i < count; i++)
+        {
+            out += syllables[below(12)];
+        }
+    }
+
+    void number()
+    {
+        out += std::to_string(below(wide() ? 1000000000 : 1000));
+        if (below(4) == 0)
+        {
+            out += ".";
+            out += std::to_string(below(100));
+        }
+    }
+
+    void string()
+    {
+        static const char* words[] = {"the", "quick", "value", "could", "not", "be", "read", "from", "this", "path"};
+        int count = wide() ? 30 + below(100) : 1 + below(4);
+        out += "\"";
+        for (int i = 0; i < count; i++)
+        {
+            out += i == 0 ? "" : " ";
+            out += words[below(10)];
+        }
+        out += "\"";
+    }
+
+    void call(int depth)
+    {
+        name();
+        out += "(";
+        int count = wide() ? 10 + below(30) : below(4);
+        for (int i = 0; i < count; i++)
+        {
+            out += i == 0 ? "" : ", ";
+            expression(depth - 1, 1 + below(2));
+        }
+        out += ")";
+    }
+
+    void iterable(int depth)
+    {
+        switch (below(depth > 0 ? 5 : 3))
+        {
+            case 0: name(); break;
+            case 1: out += "[1.." + std::to_string(1 + below(1000)) + "]"; break;
+            case 2:
+            {
+                int step = 2 + below(3);
+                int stop = 10 + below(1000);
+                out += "[1, " + std::to_string(step) + ".." + std::to_string(stop) + "]";
+                break;
+            }
+            case 3: list(depth - 1); break;
+            default: comprehension(depth - 1); break;
+        }
+    }
+
+    void list(int depth)
+    {
+        out += "[";
+        int count = 1 + below(wide() ? 40 : 5);
+        for (int i = 0; i < count; i++)
+        {
+            out += i == 0 ? "" : ", ";
+            expression(depth, 1);
+        }
+        out += "]";
+    }
+
+    void comprehension(int depth)
+    {
+        out += "[";
+        expression(depth, 1 + below(3));
+        out += " for ";
+        name();
+        out += " in ";
+        iterable(depth);
+        if (below(2) == 0)
+        {
+            out += " if ";
+            expression(0, 3);
+        }
+        out += "]";
+    }
+
+    void term(int depth)
+    {
+        switch (below(depth > 0 ? 10 : 7))
+        {
+            case 0: case 1: case 2: name(); break;
+            case 3: case 4: number(); break;
+            case 5: out += below(2) ? "true" : "false"; break;
+            case 6: string(); break;
+            case 7: call(depth); break;
+            case 8: list(depth - 1); break;
+            default: out += "("; expression(depth - 1, 2 + below(3)); out += ")"; break;
+        }
+    }
+
+    // terms joined by binary operators, depth bounds the nesting inside them
+    void expression(int depth, int terms)
+    {
+        static const char* operators[] = {" + ", " - ", " * ", " / ", " ^ ", " == ", " != ", " < ", " > ", " <= ", " >= ", " and ", " or "};
+        for (int i = 0; i < terms; i++)
+        {
+            if (i > 0)
+            {
+                out += operators[below(13)];
+            }
+            term(depth);
+        }
+    }
+
+    void indent(int level)
+    {
+        out.append(4 * level, ' ');
+    }
+
+    void assignment(int depth, int terms)
+    {
+        name();
+        out += below(3) == 0 ? " : int = " : " = ";
+        expression(depth, terms);
+        out += "\n";
+    }
+
+    void block(int level, int depth, int statements)
+    {
+        for (int i = 0; i < statements; i++)
+        {
+            statement(level, depth);
+        }
+    }
+
+    void statement(int level, int depth)
+    {
+        indent(level);
+        switch (below(depth > 0 ? 9 : 4))
+        {
+            case 0: case 1: assignment(2, 1 + below(4)); break;
+            case 2: call(2); out += "\n"; break;
+            case 3:
+                if (level == 0)
+                {
+                    // one-line definition
+                    name();
+                    out += "(";
+                    name();
+                    out += ": int, ";
+                    name();
+                    out += ": int) : int = ";
+                    expression(1, 3);
+                    out += "\n";
+                }
+                else
+                {
+                    out += "return ";
+                    expression(1, 2);
+                    out += "\n";
+                }
+                break;
+            case 4:
+                out += "if ";
+                expression(1, 3);
+                out += "\n";
+                block(level + 1, depth - 1, 1 + below(3));
+                if (below(2) == 0)
+                {
+                    indent(level);
+                    out += "else\n";
+                    block(level + 1, depth - 1, 1 + below(3));
+                }
+                break;
+            case 5:
+                out += "while ";
+                expression(1, 3);
+                out += "\n";
+                block(level + 1, depth - 1, 1 + below(3));
+                break;
+            case 6:
+                out += "for ";
+                name();
+                if (below(3) == 0)
+                {
+                    out += ", ";
+                    name();
+                }
+                out += " in ";
+                iterable(1);
+                out += "\n";
+                block(level + 1, depth - 1, 1 + below(3));
+                break;
+            default:
+                name();
+                out += "(";
+                name();
+                out += " : int)\n";
+                block(level + 1, depth - 1, 1 + below(4));
+                break;
+        }
+    }
+
+    // one top-level statement of the shape
+    void piece()
+    {
+        if (shape == "deep")
+        {
+            // a tower of blocks, then a line of deeply nested brackets
+            int levels = 16 + below(16);
+            for (int level = 0; level < levels; level++)
+            {
+                indent(level);
+                out += level % 3 == 0 ? "if " : level % 3 == 1 ? "while " : "for x in ";
+                if (level % 3 == 2)
+                {
+                    iterable(0);
+                }
+                else
+                {
+                    expression(0, 3);
+                }
+                out += "\n";
+            }
+            indent(levels);
+            name();
+            out += " = ";
+            int nesting = 8 + below(24);
+            for (int i = 0; i < nesting; i++)
+            {
+                out += below(2) ? "(" : "f(";
+            }
+            expression(0, 2);
+            out.append(nesting, ')');
+            out += "\n";
+        }
+        else if (shape == "expressions")
+        {
+            assignment(3, 50 + below(250));
+        }
+        else if (shape == "comprehensions")
+        {
+            name();
+            out += " = ";
+            comprehension(1 + below(4));
+            out += "\n";
+        }
+        else
+        {
+            statement(0, 3);
+        }
+    }
+
+    public:
+        Corpus(uint64_t seed) : state(seed) {};
+
+        // whole top-level statements until the text is at least size bytes;
+        // an unknown shape gives typical code
+        std::string generate(std::string_view shape, size_t size)
+        {
+            this->shape = shape;
+            out.clear();
+            out.reserve(size + 4096);
+            while (out.size() < size)
+            {
+                piece();
+            }
+            return std::move(out);
+        }
+};
+
+#endif
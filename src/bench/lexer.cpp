@@ -0,0 +1,63 @@
+// Lexer throughput microbenchmark.
+// g++ -std=c++17 -O2 src/bench/lexer.cpp src/lexer.cpp src/source.cpp src/scan.cpp src/pool.cpp -o lexer_bench -lpthread
+
+#include "../includes/lexer.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+
+const std::string snippet =
+    "add(x: int, y: int) : int = x + y\n"
+    "\n"
+    "fibonacci(x : int)\n"
+    "    if x <= 1 and not done\n"
+    "        return n\n"
+    "    else\n"
+    "        return add(fibonacci(n-1), fibonacci(n-2))\n"
+    "\n"
+    "xs = [fibonacci(x) for x in [1, 2..10] if x % 2 == 0]\n"
+    "while count != 100\n"
+    "    count += 1\n"
+    "    name = \"iteration\"\n";
+
+// long names, long strings and wide alignment, where run scanning matters most
+const std::string wide_snippet =
+    "configurationManagerInstance = loadConfigurationFromDefaultLocation(environmentName)\n"
+    "errorMessage = \"the configuration could not be loaded from the default location, check the path\"\n"
+    "total                                   = 1234567890123456 + 9876543210987654\n";
+
+void bench(const std::string& name, const std::string& snippet, int copies, int runs)
+{
+    std::string content;
+    content.reserve(snippet.size() * copies);
+    for (int i = 0; i < copies; i++)
+    {
+        content += snippet;
+    }
+
+    size_t tokens = 0;
+    double best = 1e300;
+    for (int i = 0; i < runs; i++)
+    {
+        Source source = Source(content);
+        auto start = std::chrono::steady_clock::now();
+        Lexer lexer = Lexer(source);
+        tokens = lexer.init().size();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+
+    std::cout << name << ": " << content.size() / (1024.0 * 1024.0) << " MB, " << tokens << " tokens, "
+              << tokens / best / 1e6 << " M tokens/s, " << content.size() / best / (1024.0 * 1024.0) << " MB/s\n";
+}
+
+int main(int argc, char** argv)
+{
+    int copies = argc > 1 ? std::stoi(argv[1]) : 20000;
+    int runs = argc > 2 ? std::stoi(argv[2]) : 10;
+
+    std::cout << "scanning with " << scan_implementation() << "\n";
+    bench("typical", snippet, copies, runs);
+    bench("wide", wide_snippet, copies, runs);
+    return 0;
+}
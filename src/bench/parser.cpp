@@ -0,0 +1,91 @@
+// Parser scaling on pathological nesting, time per token should stay flat as
+// the nesting deepens.
+// g++ -std=c++17 -O2 src/bench/parser.cpp src/parser.cpp src/lexer.cpp src/source.cpp src/scan.cpp src/arena.cpp src/json.cpp src/flat_ast.cpp src/ast.cpp src/symbols.cpp src/token_stream.cpp src/pool.cpp -o parser_bench -lpthread
+
+#include "../includes/lexer.hpp"
+#include "../includes/parser.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+
+// [[[ ... [1] ... ]]]
+std::string nested_literal(int depth)
+{
+    return "xs = " + std::string(depth, '[') + "1" + std::string(depth, ']') + "\n";
+}
+
+// [[[ ... [x for x in [1..2]] ... for x in ys] for x in ys]
+std::string nested_comprehension(int depth)
+{
+    std::string line = "xs = ";
+    for (int i = 0; i < depth; i++)
+    {
+        line += "[";
+    }
+    line += "[x for x in [1..2]]";
+    for (int i = 0; i < depth; i++)
+    {
+        line += " for x in ys]";
+    }
+    return line + "\n";
+}
+
+// f(g(g(g( ... g(1) ... ))))
+std::string nested_call(int depth)
+{
+    std::string line = "f(";
+    for (int i = 0; i < depth; i++)
+    {
+        line += "g(";
+    }
+    line += "1";
+    return line + std::string(depth + 1, ')') + "\n";
+}
+
+void bench(const std::string& name, std::string (*line)(int), int depth, int lines, int runs)
+{
+    std::string content;
+    std::string single = line(depth);
+    for (int i = 0; i < lines; i++)
+    {
+        content += single;
+    }
+
+    Source source = Source(content);
+    Lexer lexer = Lexer(source);
+    std::vector<Token> tokens = lexer.init();
+
+    double best = 1e300;
+    for (int i = 0; i < runs; i++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        Parser parser = Parser(tokens, source);
+        std::unique_ptr<Program> program = parser.parse();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+
+    std::cout << name << " depth " << depth << ": " << tokens.size() << " tokens, "
+              << best * 1e9 / tokens.size() << " ns/token\n";
+}
+
+int main(int argc, char** argv)
+{
+    int lines = argc > 1 ? std::stoi(argv[1]) : 16;
+    int runs = argc > 2 ? std::stoi(argv[2]) : 5;
+
+    // depth is bounded by the recursive descent's stack use, not by time
+    for (int depth = 250; depth <= 2000; depth *= 2)
+    {
+        bench("nested literal", nested_literal, depth, lines, runs);
+    }
+    for (int depth = 250; depth <= 2000; depth *= 2)
+    {
+        bench("nested comprehension", nested_comprehension, depth, lines, runs);
+    }
+    for (int depth = 250; depth <= 2000; depth *= 2)
+    {
+        bench("nested call", nested_call, depth, lines, runs);
+    }
+    return 0;
+}
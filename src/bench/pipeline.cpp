@@ -0,0 +1,226 @@
+// Throughput and heap allocations of every stage, lexing, parsing and JSON
+// output, on generated corpora of each shape, and of lexing and parsing
+// streamed together. Run it on two commits with the same arguments to
+// compare them; --tsv prints one line per stage for diffing.
+// g++ -std=c++17 -O2 src/bench/pipeline.cpp src/parser.cpp src/lexer.cpp src/source.cpp src/scan.cpp src/arena.cpp src/json.cpp src/flat_ast.cpp src/ast.cpp src/symbols.cpp src/token_stream.cpp src/pool.cpp -o pipeline_bench -lpthread
+//
+// pipeline_bench [--shape NAME] [--size MB] [--runs N] [--seed N] [--tsv]
+// pipeline_bench --write FILE [--shape NAME] [--size MB] [--seed N]
+
+#include "../includes/lexer.hpp"
+#include "../includes/parser.hpp"
+#include "../includes/json.hpp"
+#include "corpus.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+// every heap allocation in the process, to report each stage's per token
+static std::atomic<size_t> allocations = 0;
+
+void* operator new(size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+// peak resident set size in KB since the last reset, from /proc
+static long peak_rss()
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+    {
+        if (line.compare(0, 6, "VmHWM:") == 0)
+        {
+            return std::stol(line.substr(6));
+        }
+    }
+    return 0;
+}
+
+// so each stage reports its own peak, where the kernel allows it
+static void reset_peak_rss()
+{
+    std::ofstream("/proc/self/clear_refs") << "5";
+}
+
+static size_t count_nodes(Program& program)
+{
+    size_t count = 0;
+    std::vector<Node*> pending = {&program};
+    while (!pending.empty())
+    {
+        Node* node = pending.back();
+        pending.pop_back();
+        count++;
+        node->children(pending);
+    }
+    return count;
+}
+
+struct Stage
+{
+    double best = 1e300;
+    long peak = 0;
+    // the same on every run
+    size_t allocated = 0;
+
+    template <typename F>
+    void time(F&& run)
+    {
+        reset_peak_rss();
+        size_t before = allocations.load();
+        auto start = std::chrono::steady_clock::now();
+        run();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        allocated = allocations.load() - before;
+        best = std::min(best, elapsed.count());
+        peak = std::max(peak, peak_rss());
+    }
+};
+
+static double mb(size_t bytes)
+{
+    return bytes / (1024.0 * 1024.0);
+}
+
+void bench(const std::string& shape, size_t size, int runs, uint64_t seed, bool tsv)
+{
+    std::string content = Corpus(seed).generate(shape, size);
+    size_t tokens = 0;
+    size_t nodes = 0;
+    size_t output = 0;
+    Stage lex, parse, json, stream;
+    for (int i = 0; i < runs; i++)
+    {
+        Source source = Source(content);
+        std::vector<Token> lexed;
+        lex.time([&]
+        {
+            Lexer lexer = Lexer(source);
+            lexed = lexer.init();
+        });
+        tokens = lexed.size();
+
+        std::unique_ptr<Program> program;
+        parse.time([&]
+        {
+            Parser parser = Parser(lexed, source);
+            program = parser.parse();
+        });
+        nodes = count_nodes(*program);
+
+        json.time([&]
+        {
+            JsonWriter out = JsonWriter();
+            program->toJSON(out);
+            output = out.str().size();
+        });
+        program.reset();
+
+        stream.time([&]
+        {
+            Source streamed = Source(content);
+            Lexer lexer = Lexer(streamed);
+            Parser parser = Parser(lexer, streamed);
+            program = parser.parse();
+        });
+    }
+
+    if (tsv)
+    {
+        std::cout << shape << "\tlex\t" << lex.best << "\t" << content.size() << "\t" << tokens << "\t" << lex.peak << "\t" << lex.allocated << "\n"
+                  << shape << "\tparse\t" << parse.best << "\t" << content.size() << "\t" << nodes << "\t" << parse.peak << "\t" << parse.allocated << "\n"
+                  << shape << "\tjson\t" << json.best << "\t" << output << "\t" << nodes << "\t" << json.peak << "\t" << json.allocated << "\n"
+                  << shape << "\tstream\t" << stream.best << "\t" << content.size() << "\t" << nodes << "\t" << stream.peak << "\t" << stream.allocated << "\n";
+        return;
+    }
+    std::cout << shape << ": " << mb(content.size()) << " MB, " << tokens << " tokens, " << nodes << " nodes\n"
+              << "  lex    " << mb(content.size()) / lex.best << " MB/s, " << tokens / lex.best / 1e6 << " M tokens/s, peak RSS " << lex.peak / 1024.0 << " MB\n"
+              << "  parse  " << nodes / parse.best / 1e6 << " M nodes/s, " << tokens / parse.best / 1e6 << " M tokens/s, " << (double)parse.allocated / tokens << " allocations/token, peak RSS " << parse.peak / 1024.0 << " MB\n"
+              << "  json   " << mb(output) / json.best << " MB/s of " << mb(output) << " MB, " << nodes / json.best / 1e6 << " M nodes/s, peak RSS " << json.peak / 1024.0 << " MB\n"
+              << "  stream " << mb(content.size()) / stream.best << " MB/s lexed and parsed, " << (double)stream.allocated / tokens << " allocations/token, peak RSS " << stream.peak / 1024.0 << " MB\n";
+}
+
+int main(int argc, char** argv)
+{
+    std::string shape;
+    double size = 8;
+    int runs = 5;
+    uint64_t seed = 1;
+    bool tsv = false;
+    std::string write;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--shape" && i + 1 < argc)
+        {
+            shape = argv[++i];
+        }
+        else if (arg == "--size" && i + 1 < argc)
+        {
+            size = std::stod(argv[++i]);
+        }
+        else if (arg == "--runs" && i + 1 < argc)
+        {
+            runs = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (arg == "--seed" && i + 1 < argc)
+        {
+            seed = std::stoull(argv[++i]);
+        }
+        else if (arg == "--tsv")
+        {
+            tsv = true;
+        }
+        else if (arg == "--write" && i + 1 < argc)
+        {
+            write = argv[++i];
+        }
+        else
+        {
+            std::cerr << "unknown argument " << arg << "\n";
+            return 1;
+        }
+    }
+    size_t bytes = size * 1024 * 1024;
+
+    if (!write.empty())
+    {
+        // the corpus alone, for timing muse itself
+        std::ofstream(write, std::ios::binary) << Corpus(seed).generate(shape.empty() ? "typical" : shape, bytes);
+        return 0;
+    }
+    if (tsv)
+    {
+        std::cout << "shape\tstage\tseconds\tbytes\tcount\tpeak_kb\tallocations\n";
+    }
+    for (const char* name : corpus_shapes)
+    {
+        if (shape.empty() || shape == name)
+        {
+            bench(name, bytes, runs, seed, tsv);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include "includes/cache.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <cstdio>
+#include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+static uint64_t mix(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+uint64_t hashBytes(std::string_view bytes, uint64_t seed)
+{
+    const uint64_t multiplier = 0x9e3779b97f4a7c15ULL;
+    uint64_t h = seed ^ (bytes.size() * multiplier);
+    const char* p = bytes.data();
+    const char* end = p + bytes.size();
+    for (; end - p >= 8; p += 8)
+    {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        h = (h ^ mix(word)) * multiplier;
+        h = (h << 27) | (h >> 37);
+    }
+    uint64_t tail = 0;
+    std::memcpy(&tail, p, end - p);
+    return mix(h ^ mix(tail));
+}
+
+ParseCache::ParseCache(std::string directory, uint64_t limit, std::string variant) : directory(directory), limit(limit), variant(variant), hitCount(0), missCount(0), evictionCount(0)
+{
+    if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST)
+    {
+        throw std::runtime_error("Could not create cache directory " + directory + ": " + std::strerror(errno));
+    }
+}
+
+// <hash>-<length>.ast, the length guarding against the odd hash collision
+std::string ParseCache::path(std::string_view source) const
+{
+    uint64_t salt = (uint64_t)parser_version << 32 | ast_file_version;
+    if (!this->variant.empty())
+    {
+        salt = hashBytes(this->variant, salt);
+    }
+    char name[64];
+    snprintf(name, sizeof(name), "%016llx-%llu.ast", (unsigned long long)hashBytes(source, salt), (unsigned long long)source.size());
+    return this->directory + "/" + name;
+}
+
+std::optional<AstFile> ParseCache::find(std::string_view source)
+{
+    std::string file = this->path(source);
+    if (access(file.c_str(), F_OK) == 0)
+    {
+        try
+        {
+            std::optional<AstFile> found = AstFile::open(file);
+            utimensat(AT_FDCWD, file.c_str(), nullptr, 0); // now recently used
+            this->hitCount++;
+            return found;
+        }
+        catch (const std::runtime_error&)
+        {
+            unlink(file.c_str()); // corrupt or from an older muse, parse again
+        }
+    }
+    this->missCount++;
+    return std::nullopt;
+}
+
+void ParseCache::store(std::string_view source, const FlatAst& ast)
+{
+    writeAstFile(ast, this->path(source));
+}
+
+void ParseCache::trim()
+{
+    struct Entry
+    {
+        std::string path;
+        uint64_t size;
+        struct timespec used;
+    };
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+
+    DIR* dir = opendir(this->directory.c_str());
+    if (dir == nullptr)
+    {
+        return;
+    }
+    while (struct dirent* entry = readdir(dir))
+    {
+        std::string name = entry->d_name;
+        if (name.size() < 4 || name.compare(name.size() - 4, 4, ".ast") != 0)
+        {
+            continue;
+        }
+        std::string file = this->directory + "/" + name;
+        struct stat info;
+        if (stat(file.c_str(), &info) == 0 && S_ISREG(info.st_mode))
+        {
+            entries.push_back({file, (uint64_t)info.st_size, info.st_mtim});
+            total += info.st_size;
+        }
+    }
+    closedir(dir);
+
+    if (total <= this->limit)
+    {
+        return;
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b)
+    {
+        return a.used.tv_sec != b.used.tv_sec ? a.used.tv_sec < b.used.tv_sec : a.used.tv_nsec < b.used.tv_nsec;
+    });
+    for (const Entry& entry : entries)
+    {
+        if (total <= this->limit)
+        {
+            break;
+        }
+        if (unlink(entry.path.c_str()) == 0)
+        {
+            total -= entry.size;
+            this->evictionCount++;
+        }
+    }
+}
@@ -0,0 +1,172 @@
+#include "includes/document.hpp"
+#include "includes/lexer.hpp"
+#include "includes/parser.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+Document::Document(std::string text) : buffer(std::move(text)), lines(buffer), symbols(std::make_shared<SymbolTable>()), relexCount(0), reparseCount(0)
+{
+    // the first parse is an edit that inserts the whole text
+    this->lexed.push_back({0, 0, TokenType::EoF});
+    this->update(0, 0, 0, this->buffer.size(), 0, this->buffer.size());
+}
+
+size_t Document::pieceAt(size_t offset) const
+{
+    auto after = std::upper_bound(this->pieces.begin(), this->pieces.end(), offset, [](size_t offset, const Piece& piece)
+    {
+        return offset < piece.start;
+    });
+    return after - this->pieces.begin() - 1;
+}
+
+void Document::edit(size_t offset, size_t length, std::string_view replacement)
+{
+    if (offset > this->buffer.size() || length > this->buffer.size() - offset)
+    {
+        throw std::out_of_range("Edit runs past the end of the document");
+    }
+    // the pieces with a line the edit touches, and the one before when it
+    // starts a line, since that can indent the line into the piece before
+    size_t first = this->pieceAt(offset == 0 ? 0 : offset - 1);
+    size_t last = this->pieceAt(offset + length) + 1;
+    uint32_t start = this->pieces[first].start;
+    uint32_t oldEnd = last < this->pieces.size() ? this->pieces[last].start : this->buffer.size();
+    int64_t delta = (int64_t)replacement.size() - (int64_t)length;
+    this->buffer.replace(offset, length, replacement);
+    this->update(first, last, start, oldEnd + delta, oldEnd, delta);
+}
+
+// the whole lines in [start, end) of the new text take the place of pieces
+// [first, last), which ended at oldEnd; everything after moved by delta bytes
+void Document::update(size_t first, size_t last, uint32_t start, uint32_t end, uint32_t oldEnd, int64_t delta)
+{
+    int linesBefore = this->lines.position(start).line - 1;
+    std::vector<uint32_t> starts;
+    for (size_t line = start; line < end;)
+    {
+        starts.push_back(line);
+        const char* newline = (const char*)std::memchr(this->buffer.data() + line, '\n', end - line);
+        if (newline == nullptr)
+        {
+            break;
+        }
+        line = newline - this->buffer.data() + 1;
+    }
+    int lineDelta = this->lines.replace(this->buffer, start, oldEnd, starts, delta);
+    this->relexCount = starts.size();
+
+    std::vector<Token> relexed;
+    std::string error;
+    try
+    {
+        Lexer lexer = Lexer(this->lines);
+        relexed = lexer.relex(start, end, linesBefore);
+    }
+    catch (const std::exception& e)
+    {
+        error = e.what();
+    }
+
+    size_t firstToken = 0;
+    size_t oldTokens = 0;
+    for (size_t i = 0; i < last; i++)
+    {
+        (i < first ? firstToken : oldTokens) += this->pieces[i].tokenCount;
+    }
+    this->lexed.erase(this->lexed.begin() + firstToken, this->lexed.begin() + firstToken + oldTokens);
+    this->lexed.insert(this->lexed.begin() + firstToken, relexed.begin(), relexed.end());
+    for (size_t i = firstToken + relexed.size(); i < this->lexed.size(); i++)
+    {
+        this->lexed[i].offset += delta;
+    }
+
+    // the new lines hold one piece per top-level statement
+    std::vector<size_t> cuts = Parser::top_level_starts(relexed);
+    cuts.insert(cuts.begin(), 0);
+    std::vector<Piece> fresh(cuts.size());
+    for (size_t i = 0; i < cuts.size(); i++)
+    {
+        size_t next = i + 1 < cuts.size() ? cuts[i + 1] : relexed.size();
+        fresh[i].start = i == 0 ? start : relexed[cuts[i]].offset - this->lines.position(relexed[cuts[i]]).column;
+        fresh[i].tokenCount = next - cuts[i];
+    }
+    fresh[0].error = error;
+    this->pieces.erase(this->pieces.begin() + first, this->pieces.begin() + last);
+    this->pieces.insert(this->pieces.begin() + first, std::make_move_iterator(fresh.begin()), std::make_move_iterator(fresh.end()));
+
+    // the pieces after keep their trees, only moved down the text
+    std::vector<Node*> pending;
+    for (size_t i = first + fresh.size(); i < this->pieces.size(); i++)
+    {
+        Piece& piece = this->pieces[i];
+        piece.start += delta;
+        if (lineDelta == 0)
+        {
+            continue;
+        }
+        pending.assign(piece.statements.begin(), piece.statements.end());
+        while (!pending.empty())
+        {
+            Node* node = pending.back();
+            pending.pop_back();
+            node->span.start.line += lineDelta;
+            node->span.end.line += lineDelta;
+            node->children(pending);
+        }
+    }
+
+    this->reparseCount = 0;
+    size_t token = firstToken;
+    for (size_t i = first; i < first + fresh.size(); i++)
+    {
+        this->parse(this->pieces[i], token);
+        token += this->pieces[i].tokenCount;
+    }
+
+    std::vector<Statement*> statements;
+    for (const Piece& piece : this->pieces)
+    {
+        statements.insert(statements.end(), piece.statements.begin(), piece.statements.end());
+    }
+    Arena arena;
+    ArenaArray<Statement*> items = arena.array(statements);
+    Span span = {this->lines.position(this->lexed.front()), this->lines.position(this->lexed.back())};
+    this->tree = std::make_unique<Program>(std::move(arena), items, span, this->symbols);
+}
+
+void Document::parse(Piece& piece, size_t firstToken)
+{
+    if (piece.tokenCount == 0)
+    {
+        return;
+    }
+    std::vector<Token> slice(this->lexed.begin() + firstToken, this->lexed.begin() + firstToken + piece.tokenCount);
+    // ended where the next statement begins, so spans come out as in a whole parse
+    slice.push_back({this->lexed[firstToken + piece.tokenCount].offset, 0, TokenType::EoF});
+    try
+    {
+        Parser parser = Parser(std::move(slice), this->lines, this->symbols);
+        piece.statements = parser.parse_top_level(piece.arena);
+        this->reparseCount += piece.statements.size();
+    }
+    catch (const std::exception& e)
+    {
+        piece.error = e.what();
+    }
+}
+
+std::vector<std::string> Document::errors() const
+{
+    std::vector<std::string> found;
+    for (const Piece& piece : this->pieces)
+    {
+        if (!piece.error.empty())
+        {
+            found.push_back("line " + std::to_string(this->lines.position(piece.start).line) + ": " + piece.error);
+        }
+    }
+    return found;
+}
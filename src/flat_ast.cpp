@@ -0,0 +1,374 @@
+#include "includes/flat_ast.hpp"
+
+FlatAst::FlatAst(Program& program) : FlatAst()
+{
+    this->symbols = &program.symbols();
+    program.flatten(*this);
+}
+
+AstView FlatAst::view() const
+{
+    return {
+        (uint32_t)this->kinds.size(),
+        this->kinds.data(),
+        this->spans.data(),
+        this->childRanges.data(),
+        this->payloads.data(),
+        this->children.data(),
+        this->numbers.data(),
+        this->strings.data(),
+        this->stringData.data(),
+    };
+}
+
+FlatAst::View<uint32_t> FlatAst::childrenOf(uint32_t node) const
+{
+    Range range = this->childRanges[node];
+    return {this->children.data() + range.first, range.count};
+}
+
+FlatAst::View<double> FlatAst::numbersOf(uint32_t node) const
+{
+    Range range = this->payloads[node];
+    return {this->numbers.data() + range.first, range.count};
+}
+
+std::string_view FlatAst::string(uint32_t index) const
+{
+    Range range = this->strings[index];
+    return std::string_view(this->stringData).substr(range.first, range.count);
+}
+
+uint32_t FlatAst::add(NodeKind kind, Span span)
+{
+    this->kinds.push_back(kind);
+    this->spans.push_back(span);
+    this->childRanges.push_back({0, 0});
+    this->payloads.push_back({0, 0});
+    return this->kinds.size() - 1;
+}
+
+uint32_t FlatAst::intern(std::string_view text)
+{
+    auto [at, added] = this->interned.try_emplace(std::string(text), (uint32_t)this->stringData.size());
+    if (added)
+    {
+        this->stringData.append(text);
+    }
+    return at->second;
+}
+
+uint32_t FlatAst::addString(std::string_view text)
+{
+    this->strings.push_back({this->intern(text), (uint32_t)text.size()});
+    return this->strings.size() - 1;
+}
+
+uint32_t FlatAst::addSymbol(Symbol symbol)
+{
+    const uint32_t unseen = UINT32_MAX;
+    if (symbol.id >= this->symbolOffsets.size())
+    {
+        this->symbolOffsets.resize(symbol.id + 1, unseen);
+    }
+    std::string_view text = this->symbols->name(symbol);
+    uint32_t& offset = this->symbolOffsets[symbol.id];
+    if (offset == unseen)
+    {
+        offset = this->intern(text);
+    }
+    this->strings.push_back({offset, (uint32_t)text.size()});
+    return this->strings.size() - 1;
+}
+
+uint32_t FlatAst::addOperator(Operator op)
+{
+    std::string_view text = operator_text(op);
+    uint32_t& offset = this->operatorOffsets[(size_t)op];
+    if (offset == UINT32_MAX)
+    {
+        offset = this->intern(text);
+    }
+    this->strings.push_back({offset, (uint32_t)text.size()});
+    return this->strings.size() - 1;
+}
+
+uint32_t FlatAst::addNumber(double value)
+{
+    this->numbers.push_back(value);
+    return this->numbers.size() - 1;
+}
+
+void FlatAst::setPayload(uint32_t node, uint32_t first, uint32_t count)
+{
+    this->payloads[node] = {first, count};
+}
+
+void FlatAst::closeChildren(uint32_t node, size_t mark)
+{
+    this->childRanges[node] = {(uint32_t)this->children.size(), (uint32_t)(this->pending.size() - mark)};
+    this->children.insert(this->children.end(), this->pending.begin() + mark, this->pending.end());
+    this->pending.resize(mark);
+}
+
+// every flatten follows the same shape: add the node so it precedes its
+// children, flatten the children onto the pending stack, then close the list
+
+uint32_t Program::flatten(FlatAst& flat)
+{
+    size_t mark = flat.openChildren();
+    uint32_t node = flat.add(NodeKind::Program, this->span);
+    for (Statement* statement : this->program)
+    {
+        flat.child(statement->flatten(flat));
+    }
+    flat.closeChildren(node, mark);
+    return node;
+}
+
+uint32_t StatementBlock::flatten(FlatAst& flat)
+{
+    size_t mark = flat.openChildren();
+    uint32_t node = flat.add(NodeKind::StatementBlock, this->span);
+    for (Statement* statement : this->statements)
+    {
+        flat.child(statement->flatten(flat));
+    }
+    flat.closeChildren(node, mark);
+    return node;
+}
+
+uint32_t Parameter::flatten(FlatAst& flat)
+{
+    uint32_t node = flat.add(NodeKind::Parameter, this->span);
+    uint32_t first = flat.addSymbol(this->id);
+    flat.addSymbol(this->type);
+    flat.setPayload(node, first, 2);
+    return node;
+}
+
+uint32_t FunctionPrototype::flatten(FlatAst& flat)
+{
+    size_t mark = flat.openChildren();
+    uint32_t node = flat.add(NodeKind::FunctionPrototype, this->span);
+    uint32_t first = flat.addSymbol(this->name);
+    flat.addSymbol(this->return_type);
+    flat.setPayload(node, first, 2);
+    for (Parameter* param : this->params)
+    {
+        flat.child(param->flatten(flat));
+    }
+    flat.closeChildren(node, mark);
+    return node;
+}
+
+uint32_t FunctionDefenition::flatten(FlatAst& flat)
+{
+    size_t mark = flat.openChildren();
+    uint32_t node = flat.add(NodeKind::FunctionDefenition, this->span);
+    flat.child(this->prototype->flatten(flat));
+    flat.child(this->body->flatten(flat));
+    flat.closeChildren(node, mark);
+    return node;
+}
+
+uint32_t ReturnStatement::flatten(FlatAst& flat)
+{
+    size_t mark = flat.openChildren();
+    uint32_t node = flat.add(NodeKind::ReturnStatement, this->span);
+    flat.child(this->statement->flatten(flat));
+    flat.closeChildren(node, mark);
+    return node;
+}
+
+uint32_t ForLoop::flatten(FlatAst& flat)
+{
+    size_t mark = flat.openChildren();
+    uint32_t node = flat.add(NodeKind::ForLoop, this->span);
+    for (Identifier* id : this->ids)
+    {
+        flat.child(id->flatten(flat));
+    }
+    flat.child(this->iterable->flatten(flat));
+    flat.child(this->body->flatten(flat));
+    flat.closeChildren(node, mark);
+    return node;
+}
+
+uint32_t WhileLoop::flatten(FlatAst& flat)
+{
+    size_t mark = flat.openChildren();
+    uint32_t node = flat.add(NodeKind::WhileLoop, this->span);
+    flat.child(this->condition->flatten(flat));
+    flat.child(this->body->flatten(flat));
+    flat.closeChildren(node, mark);
+    return node;
+}
+
+uint32_t Assignment::flatten(FlatAst& flat)
+{
+    size_t mark = flat.openChildren();
+    uint32_t node = flat.add(NodeKind::Assignment, this->span);
+    uint32_t first = flat.addSymbol(this->id);
+    flat.addSymbol(this->type);
+    flat.setPayload(node, first, 2);
+    flat.child(this->rhs->flatten(flat));
+    flat.closeChildren(node, mark);
+    return node;
+}
+
+uint32_t IfStatement::flatten(FlatAst& flat)
+{
+    size_t mark = flat.openChildren();
+    uint32_t node = flat.add(NodeKind::IfStatement, this->span);
+    flat.child(this->conditional->flatten(flat));
+    flat.child(this->ifBlock->flatten(flat));
+    flat.child(this->elseBlock->flatten(flat));
+    flat.closeChildren(node, mark);
+    return node;
+}
+
+uint32_t Identifier::flatten(FlatAst& flat)
+{
+    uint32_t node = flat.add(NodeKind::Identifier, this->span);
+    flat.setPayload(node, flat.addSymbol(this->value), 1);
+    return node;
+}
+
+uint32_t NumericLiteral::flatten(FlatAst& flat)
+{
+    uint32_t node = flat.add(NodeKind::NumericLiteral, this->span);
+    flat.setPayload(node, flat.addNumber(this->value), 1);
+    return node;
+}
+
+uint32_t BooleanLiteral::flatten(FlatAst& flat)
+{
+    uint32_t node = flat.add(NodeKind::BooleanLiteral, this->span);
+    flat.setPayload(node, this->value, 0);
+    return node;
+}
+
+uint32_t StringLiteral::flatten(FlatAst& flat)
+{
+    uint32_t node = flat.add(NodeKind::StringLiteral, this->span);
+    flat.setPayload(node, flat.addString(this->value), 1);
+    return node;
+}
+
+uint32_t IterableLiteral::flatten(FlatAst& flat)
+{
+    size_t mark = flat.openChildren();
+    uint32_t node = flat.add(NodeKind::IterableLiteral, this->span);
+    for (Expression* value : this->value)
+    {
+        flat.child(value->flatten(flat));
+    }
+    flat.closeChildren(node, mark);
+    return node;
+}
+
+uint32_t Subscription::flatten(FlatAst& flat)
+{
+    size_t mark = flat.openChildren();
+    uint32_t node = flat.add(NodeKind::Subscription, this->span);
+    flat.child(this->id->flatten(flat));
+    flat.child(this->index->flatten(flat));
+    flat.closeChildren(node, mark);
+    return node;
+}
+
+uint32_t AttributeReference::flatten(FlatAst& flat)
+{
+    size_t mark = flat.openChildren();
+    uint32_t node = flat.add(NodeKind::AttributeReference, this->span);
+    flat.child(this->object->flatten(flat));
+    flat.child(this->attribute->flatten(flat));
+    flat.closeChildren(node, mark);
+    return node;
+}
+
+uint32_t Slice::flatten(FlatAst& flat)
+{
+    size_t mark = flat.openChildren();
+    uint32_t node = flat.add(NodeKind::Slice, this->span);
+    flat.child(this->id->flatten(flat));
+    flat.child(this->start->flatten(flat));
+    flat.child(this->stop->flatten(flat));
+    flat.closeChildren(node, mark);
+    return node;
+}
+
+uint32_t List::flatten(FlatAst& flat)
+{
+    uint32_t node = flat.add(NodeKind::List, this->span);
+    uint32_t first = flat.strings.size();
+    for (std::string_view element : this->elements)
+    {
+        flat.addString(element);
+    }
+    flat.setPayload(node, first, this->elements.size());
+    return node;
+}
+
+uint32_t Set::flatten(FlatAst& flat)
+{
+    uint32_t node = flat.add(NodeKind::Set, this->span);
+    uint32_t first = flat.addNumber((double)this->Type);
+    for (double element : this->elements)
+    {
+        flat.addNumber(element);
+    }
+    flat.setPayload(node, first, this->elements.size() + 1);
+    return node;
+}
+
+uint32_t Generator::flatten(FlatAst& flat)
+{
+    size_t mark = flat.openChildren();
+    uint32_t node = flat.add(NodeKind::Generator, this->span);
+    flat.child(this->start->flatten(flat));
+    flat.child(this->step->flatten(flat));
+    flat.child(this->stop->flatten(flat));
+    flat.closeChildren(node, mark);
+    return node;
+}
+
+uint32_t BinaryExpression::flatten(FlatAst& flat)
+{
+    size_t mark = flat.openChildren();
+    uint32_t node = flat.add(NodeKind::BinaryExpression, this->span);
+    flat.setPayload(node, flat.addOperator(this->op), 1);
+    flat.child(this->lhs->flatten(flat));
+    flat.child(this->rhs->flatten(flat));
+    flat.closeChildren(node, mark);
+    return node;
+}
+
+uint32_t ListComprehension::flatten(FlatAst& flat)
+{
+    size_t mark = flat.openChildren();
+    uint32_t node = flat.add(NodeKind::ListComprehension, this->span);
+    flat.child(this->body->flatten(flat));
+    flat.child(this->iterable->flatten(flat));
+    flat.child(this->filter->flatten(flat));
+    for (Identifier* id : this->ids)
+    {
+        flat.child(id->flatten(flat));
+    }
+    flat.closeChildren(node, mark);
+    return node;
+}
+
+uint32_t FunctionCall::flatten(FlatAst& flat)
+{
+    size_t mark = flat.openChildren();
+    uint32_t node = flat.add(NodeKind::FunctionCall, this->span);
+    flat.setPayload(node, flat.addSymbol(this->id), 1);
+    for (Expression* arg : this->args)
+    {
+        flat.child(arg->flatten(flat));
+    }
+    flat.closeChildren(node, mark);
+    return node;
+}
@@ -0,0 +1,229 @@
+#include "includes/fold.hpp"
+#include "includes/range.hpp"
+#include "includes/visitor.hpp"
+#include <cmath>
+#include <type_traits>
+#include <unordered_set>
+
+static bool arithmetic(Operator op)
+{
+    switch (op)
+    {
+        case Operator::Power:
+        case Operator::Multiply:
+        case Operator::Divide:
+        case Operator::Add:
+        case Operator::Subtract:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool is_number(Expression* expression, double value)
+{
+    return expression->kind == NodeKind::NumericLiteral && static_cast<NumericLiteral*>(expression)->value == value;
+}
+
+class ConstantFolder : public Visitor<ConstantFolder, Node*>
+{
+    Arena& arena;
+    // arithmetic over numbers that was left unfolded, like 1 / 0, found
+    // bottom up so that asking about an operand never walks its subtree
+    std::unordered_set<Expression*> numericExpressions;
+
+    // whether an expression is sure to be a number, so that adding zero to
+    // it or multiplying it by one leaves it as it was. Names, calls and the
+    // like could be anything, a string say, and are left alone.
+    bool numeric(Expression* expression) const
+    {
+        return expression->kind == NodeKind::NumericLiteral || this->numericExpressions.count(expression) != 0;
+    };
+
+    BooleanLiteral* boolean(bool value, Span span)
+    {
+        return this->arena.make<BooleanLiteral>(value, span);
+    };
+
+    Expression* numbers(BinaryExpression* node, double lhs, double rhs)
+    {
+        double value;
+        switch (node->op)
+        {
+            case Operator::Power: value = std::pow(lhs, rhs); break;
+            case Operator::Multiply: value = lhs * rhs; break;
+            case Operator::Divide:
+                if (rhs == 0)
+                {
+                    return node;
+                }
+                value = lhs / rhs;
+                break;
+            case Operator::Add: value = lhs + rhs; break;
+            case Operator::Subtract: value = lhs - rhs; break;
+            case Operator::Equal: return this->boolean(lhs == rhs, node->span);
+            case Operator::NotEqual: return this->boolean(lhs != rhs, node->span);
+            case Operator::MoreEqual: return this->boolean(lhs >= rhs, node->span);
+            case Operator::LessEqual: return this->boolean(lhs <= rhs, node->span);
+            case Operator::More: return this->boolean(lhs > rhs, node->span);
+            case Operator::Less: return this->boolean(lhs < rhs, node->span);
+            default: return node;
+        }
+        if (!std::isfinite(value))
+        {
+            return node;
+        }
+        return this->arena.make<NumericLiteral>(value, node->span);
+    };
+
+    Expression* booleans(BinaryExpression* node, bool lhs, bool rhs)
+    {
+        switch (node->op)
+        {
+            case Operator::And: return this->boolean(lhs && rhs, node->span);
+            case Operator::Or: return this->boolean(lhs || rhs, node->span);
+            case Operator::Equal: return this->boolean(lhs == rhs, node->span);
+            case Operator::NotEqual: return this->boolean(lhs != rhs, node->span);
+            default: return node;
+        }
+    };
+
+    // x in [a, b..c] for a number x and a generator of literals, checked
+    // against the range in closed form rather than number by number
+    Expression* membership(BinaryExpression* node, double value, const Generator& generator)
+    {
+        std::optional<Range> range = constantRange(generator);
+        if (!range)
+        {
+            return node;
+        }
+        return this->boolean(range->contains(value), node->span);
+    };
+
+    // a generator iterated with literal bounds keeps its numbers as a range,
+    // for the loop or comprehension to step through without storing them
+    void lower(Value* iterable)
+    {
+        if (iterable->kind == NodeKind::Generator)
+        {
+            Generator* generator = static_cast<Generator*>(iterable);
+            generator->range = constantRange(*generator);
+        }
+    };
+
+    Expression* identity(BinaryExpression* node)
+    {
+        Expression* lhs = node->lhs;
+        Expression* rhs = node->rhs;
+        switch (node->op)
+        {
+            case Operator::Multiply:
+                if (is_number(rhs, 1) && this->numeric(lhs))
+                {
+                    return lhs;
+                }
+                if (is_number(lhs, 1) && this->numeric(rhs))
+                {
+                    return rhs;
+                }
+                break;
+            case Operator::Add:
+                if (is_number(rhs, 0) && this->numeric(lhs))
+                {
+                    return lhs;
+                }
+                if (is_number(lhs, 0) && this->numeric(rhs))
+                {
+                    return rhs;
+                }
+                break;
+            case Operator::Subtract:
+                if (is_number(rhs, 0) && this->numeric(lhs))
+                {
+                    return lhs;
+                }
+                break;
+            case Operator::Divide:
+            case Operator::Power:
+                if (is_number(rhs, 1) && this->numeric(lhs))
+                {
+                    return lhs;
+                }
+                break;
+            default:
+                break;
+        }
+        return node;
+    };
+
+    public:
+        uint64_t removed = 0;
+
+        ConstantFolder(Arena& arena) : arena(arena) {};
+
+        // folds the children, putting what they fold to in their place
+        Node* visitNode(Node* node)
+        {
+            eachChild(node, [&](auto*& child)
+            {
+                child = static_cast<std::remove_reference_t<decltype(child)>>(this->visit(child));
+            });
+            return node;
+        };
+
+        Node* visitForLoop(ForLoop* node)
+        {
+            this->visitNode(node);
+            this->lower(node->iterable);
+            return node;
+        };
+
+        Node* visitListComprehension(ListComprehension* node)
+        {
+            this->visitNode(node);
+            this->lower(node->iterable);
+            return node;
+        };
+
+        Node* visitBinaryExpression(BinaryExpression* node)
+        {
+            this->visitNode(node);
+            Expression* folded;
+            // a literal made from two literal operands, or an operand kept and
+            // a literal dropped, leaves the tree two nodes smaller
+            uint64_t dropped = 2;
+            if (node->lhs->kind == NodeKind::NumericLiteral && node->rhs->kind == NodeKind::NumericLiteral)
+            {
+                folded = this->numbers(node, static_cast<NumericLiteral*>(node->lhs)->value, static_cast<NumericLiteral*>(node->rhs)->value);
+            }
+            else if (node->lhs->kind == NodeKind::BooleanLiteral && node->rhs->kind == NodeKind::BooleanLiteral)
+            {
+                folded = this->booleans(node, static_cast<BooleanLiteral*>(node->lhs)->value, static_cast<BooleanLiteral*>(node->rhs)->value);
+            }
+            else if (node->op == Operator::In && node->lhs->kind == NodeKind::NumericLiteral && node->rhs->kind == NodeKind::Generator)
+            {
+                folded = this->membership(node, static_cast<NumericLiteral*>(node->lhs)->value, *static_cast<Generator*>(node->rhs));
+                dropped = 5; // the generator and its three literals too
+            }
+            else
+            {
+                folded = this->identity(node);
+            }
+            if (folded != node)
+            {
+                this->removed += dropped;
+            }
+            else if (arithmetic(node->op) && this->numeric(node->lhs) && this->numeric(node->rhs))
+            {
+                this->numericExpressions.insert(node);
+            }
+            return folded;
+        };
+};
+
+uint64_t foldConstants(Program& program)
+{
+    ConstantFolder folder = ConstantFolder(program.nodeArena());
+    folder.visit(&program);
+    return folder.removed;
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// A fixed-size array allocated in an Arena.
+template <typename T>
+class ArenaArray
+{
+    T* items;
+    uint32_t count;
+
+    public:
+        ArenaArray() : items(nullptr), count(0) {};
+        ArenaArray(T* items, uint32_t count) : items(items), count(count) {};
+
+        T* begin() const { return items; };
+        T* end() const { return items + count; };
+        uint32_t size() const { return count; };
+        bool empty() const { return count == 0; };
+        T& operator[](uint32_t i) const { return items[i]; };
+};
+
+// Bump allocator handing out memory from a few large chunks, all released at
+// once when the arena is destroyed. Destructors of the objects in it are never
+// run, so only trivially destructible types may be allocated.
+class Arena
+{
+    std::vector<char*> chunks;
+    char* cursor;
+    char* limit;
+    size_t nextChunkSize;
+    size_t used;
+
+    void* grow(size_t size, size_t align);
+
+    public:
+        Arena() : cursor(nullptr), limit(nullptr), nextChunkSize(4 * 1024), used(0) {};
+        Arena(Arena&& other);
+        Arena& operator=(Arena&& other);
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+        ~Arena();
+
+        void* allocate(size_t size, size_t align)
+        {
+            uintptr_t p = ((uintptr_t)cursor + align - 1) & ~(uintptr_t)(align - 1);
+            if (cursor == nullptr || p + size > (uintptr_t)limit)
+            {
+                return grow(size, align);
+            }
+            cursor = (char*)(p + size);
+            used += size;
+            return (void*)p;
+        };
+
+        template <typename T, typename... Args>
+        T* make(Args&&... args)
+        {
+            static_assert(std::is_trivially_destructible<T>::value, "arena objects are never destroyed");
+            return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        };
+
+        template <typename T>
+        ArenaArray<T> array(const std::vector<T>& items)
+        {
+            static_assert(std::is_trivially_destructible<T>::value, "arena objects are never destroyed");
+            if (items.empty())
+            {
+                return {};
+            }
+            T* copy = (T*)allocate(sizeof(T) * items.size(), alignof(T));
+            std::uninitialized_copy(items.begin(), items.end(), copy);
+            return {copy, (uint32_t)items.size()};
+        };
+
+        std::string_view string(std::string_view text)
+        {
+            if (text.empty())
+            {
+                return {};
+            }
+            char* copy = (char*)allocate(text.size(), 1);
+            std::memcpy(copy, text.data(), text.size());
+            return {copy, text.size()};
+        };
+
+        // takes over everything allocated in other, which is left empty
+        void adopt(Arena&& other);
+
+        size_t bytesUsed() const { return used; };
+
+        size_t chunkCount() const { return chunks.size(); };
+};
+
+#endif
@@ -5,76 +5,128 @@
 
 #include "token.hpp"
 #include "span.hpp"
-#include <vector>
+#include <string>
+#include <string_view>
+#include <memory>
+#include "arena.hpp"
+#include "symbols.hpp"
+#include "operators.hpp"
+#include "range.hpp"
 // #include "llvm/IR/BasicBlock.h"
 
 // base classes
 #include "types.hpp"
 
+class FlatAst;
+class JsonWriter;
+
+// one per concrete node class
+enum class NodeKind : uint8_t
+{
+    Program,
+    StatementBlock,
+    Parameter,
+    FunctionPrototype,
+    FunctionDefenition,
+    ReturnStatement,
+    ForLoop,
+    WhileLoop,
+    Assignment,
+    IfStatement,
+    Identifier,
+    NumericLiteral,
+    BooleanLiteral,
+    StringLiteral,
+    IterableLiteral,
+    Subscription,
+    AttributeReference,
+    Slice,
+    List,
+    Set,
+    Generator,
+    BinaryExpression,
+    ListComprehension,
+    FunctionCall,
+};
+
 class JSONSerializable
 {
     public:
-        virtual std::string toJSON(int lvl) = 0;
+        virtual void toJSON(JsonWriter& out) = 0;
 };
 
 class Node : public JSONSerializable
 {
     public:
+        // the concrete class, which passes switch on, see visitor.hpp
+        NodeKind kind;
         Span span;
-        Node(Span span) : span(span) {};
-        std::string toJSON(int lvl) override { return "Should not happen";};
-        virtual ~Node() = default;
+        Node(NodeKind kind, Span span) : kind(kind), span(span) {};
+        // appends this subtree to a flat AST, returning the node's index
+        virtual uint32_t flatten(FlatAst& flat) = 0;
+        // appends the node's direct children to out
+        void children(std::vector<Node*>& out);
+        // nodes live in their Program's arena and are released with it, never
+        // destroyed one by one, so they hold no owning members
         // virtual llvm::Value *codegen() =0;
 };
 
 class Statement : public Node
 {
     public:
-        Statement(Span span) : Node(span) {};
-        std::string toJSON(int lvl) override { return "Should not happen";};
+        Statement(NodeKind kind, Span span) : Node(kind, span) {};
         // llvm::Value *codegen() override;
 };
 
 class Program: public Node
 {
-    std::vector<std::unique_ptr<Statement>> program;
+    Arena arena;
+    // the names the nodes' symbols stand for
+    std::shared_ptr<SymbolTable> table;
     Span x;
     public:
-        Program(std::vector<std::unique_ptr<Statement>> program, Span span): program(std::move(program)), Node(span) {};
-        std::string toJSON(int lvl) override;
+        ArenaArray<Statement*> program;
+
+        Program(Arena arena, ArenaArray<Statement*> program, Span span, std::shared_ptr<SymbolTable> table): arena(std::move(arena)), program(program), table(std::move(table)), Node(NodeKind::Program, span) {};
+        // bytes of nodes held in the arena
+        size_t bytesUsed() const { return arena.bytesUsed(); };
+        // where passes allocate the nodes they put in the tree
+        Arena& nodeArena() { return arena; };
+        const SymbolTable& symbols() const { return *table; };
+        void toJSON(JsonWriter& out) override;
+        uint32_t flatten(FlatAst& flat) override;
         // llvm::Value *codegen() override;
 };
 
 class Expression : public Statement
 {
     public:
-        Expression(Span span) : Statement(span) {};
-        std::string toJSON(int lvl) override { return "Should not happen";};
+        Expression(NodeKind kind, Span span) : Statement(kind, span) {};
         // llvm::Value *codegen() override;
 };
 
 class Value : public Expression
 {
     public: 
-        Value(Span span) : Expression(span) {};
-        std::string toJSON(int lvl) override { return "Should not happen";};
+        Value(NodeKind kind, Span span) : Expression(kind, span) {};
         // llvm::Value *codegen() override;
 };
 
 class Identifier : public Value
 {
-    std::string value;
     public:
-        Identifier(std::string value, Span span) : value(value), Value(span) {};
-        std::string toJSON(int lvl) override;
+        Symbol value;
+
+        Identifier(Symbol value, Span span) : value(value), Value(NodeKind::Identifier, span) {};
+        void toJSON(JsonWriter& out) override;
+        uint32_t flatten(FlatAst& flat) override;
         // llvm::Value *codegen() override;
 };
 
 class Iterable : public Value
 {
     public:
-        Iterable(Span span) : Value(span) {};
-        std::string toJSON(int lvl) override { return "Should not happen";};
+        Iterable(NodeKind kind, Span span) : Value(kind, span) {};
         // llvm::Value *codegen() override;
 };
 
@@ -82,94 +134,112 @@ class Iterable : public Value
 
 class StatementBlock : public Statement
 {
-    std::vector<std::unique_ptr<Statement>> statements;
     public:
-        StatementBlock(std::vector<std::unique_ptr<Statement>> statements, Span span) : statements(std::move(statements)), Statement(span) {};
-        std::string toJSON(int lvl) override;
+        ArenaArray<Statement*> statements;
+
+        StatementBlock(ArenaArray<Statement*> statements, Span span) : statements(statements), Statement(NodeKind::StatementBlock, span) {};
+        void toJSON(JsonWriter& out) override;
+        uint32_t flatten(FlatAst& flat) override;
         // llvm::Value *codegen() override;
 };
 
 class Parameter : public Node
 {
-    std::string id;
-    std::string type;
-    public: 
-        Parameter(std::string id, std::string type, Span span) : id(id), type(type), Node(span) {};
-        std::string toJSON(int lvl) override;
+    public:
+        Symbol id;
+        Symbol type;
+
+        Parameter(Symbol id, Symbol type, Span span) : id(id), type(type), Node(NodeKind::Parameter, span) {};
+        void toJSON(JsonWriter& out) override;
+        uint32_t flatten(FlatAst& flat) override;
         // llvm::Value *codegen() override;
 };
 
 class FunctionPrototype : public Statement
 {
-    std::string name;
-    std::vector<std::unique_ptr<Parameter>> params;
-    std::string return_type;
     public:
-        FunctionPrototype(std::string name, std::vector<std::unique_ptr<Parameter>> params, std::string return_type, Span span) : name(name), params(std::move(params)), return_type(return_type), Statement(span) {};
-        std::string toJSON(int lvl) override;
+        Symbol name;
+        ArenaArray<Parameter*> params;
+        Symbol return_type;
+
+        FunctionPrototype(Symbol name, ArenaArray<Parameter*> params, Symbol return_type, Span span) : name(name), params(params), return_type(return_type), Statement(NodeKind::FunctionPrototype, span) {};
+        void toJSON(JsonWriter& out) override;
+        uint32_t flatten(FlatAst& flat) override;
         // llvm::Value *codegen() override;
 };
 
 class FunctionDefenition : public Statement
 {
-    std::unique_ptr<FunctionPrototype> prototype;
-    std::unique_ptr<Statement> body; // only ever an Expression or a StatementBlock
     public:
-        FunctionDefenition(std::unique_ptr<FunctionPrototype> prototype, std::unique_ptr<Statement> body, Span span) : prototype(std::move(prototype)), body(std::move(body)), Statement(span) {};
-        std::string toJSON(int lvl) override;
+        FunctionPrototype* prototype;
+        Statement* body; // only ever an Expression or a StatementBlock
+
+        FunctionDefenition(FunctionPrototype* prototype, Statement* body, Span span) : prototype(prototype), body(body), Statement(NodeKind::FunctionDefenition, span) {};
+        void toJSON(JsonWriter& out) override;
+        uint32_t flatten(FlatAst& flat) override;
         // llvm::Value *codegen() override;
 };
 
 class ReturnStatement : public Statement
 {
-    std::unique_ptr<Expression> statement;
     public:
-        ReturnStatement(std::unique_ptr<Expression> statement, Span span) : statement(std::move(statement)), Statement(span) {};
-        std::string toJSON(int lvl) override;
+        Expression* statement;
+
+        ReturnStatement(Expression* statement, Span span) : statement(statement), Statement(NodeKind::ReturnStatement, span) {};
+        void toJSON(JsonWriter& out) override;
+        uint32_t flatten(FlatAst& flat) override;
         // llvm::Value *codegen() override;
 };
 
 class ForLoop : public Statement
 {
-    std::unique_ptr<StatementBlock> body;
-    std::unique_ptr<Value> iterable;
-    std::vector<std::unique_ptr<Identifier>> ids;
     public:
-        ForLoop(std::vector<std::unique_ptr<Identifier>> ids, std::unique_ptr<Value> iterable, std::unique_ptr<StatementBlock> body, Span span) : body(std::move(body)), iterable(std::move(iterable)), ids(std::move(ids)), Statement(span) {};
-        std::string toJSON(int lvl) override;
+        StatementBlock* body;
+        Value* iterable;
+        ArenaArray<Identifier*> ids;
+
+        ForLoop(ArenaArray<Identifier*> ids, Value* iterable, StatementBlock* body, Span span) : body(body), iterable(iterable), ids(ids), Statement(NodeKind::ForLoop, span) {};
+        void toJSON(JsonWriter& out) override;
+        uint32_t flatten(FlatAst& flat) override;
         // llvm::Value *codegen() override;
 
 };
 
 class WhileLoop : public Statement
 {
-    std::unique_ptr<Expression> condition;
-    std::unique_ptr<StatementBlock> body;
     public:
-        WhileLoop(std::unique_ptr<Expression> condition, std::unique_ptr<StatementBlock> body, Span span) : condition(std::move(condition)), body(std::move(body)), Statement(span) {};
-        std::string toJSON(int lvl) override;
+        Expression* condition;
+        StatementBlock* body;
+
+        WhileLoop(Expression* condition, StatementBlock* body, Span span) : condition(condition), body(body), Statement(NodeKind::WhileLoop, span) {};
+        void toJSON(JsonWriter& out) override;
+        uint32_t flatten(FlatAst& flat) override;
         // llvm::Value *codegen() override;
 };
 
 class Assignment : public Statement
 {
-    std::string id;
-    std::string type;
-    std::unique_ptr<Expression> rhs;
     public:
-        Assignment(std::string id, std::string type, std::unique_ptr<Expression> rhs, Span span) : id(id), type(type), rhs(std::move(rhs)), Statement(span) {};
-        std::string toJSON(int lvl) override;
+        Symbol id;
+        Symbol type;
+        Expression* rhs;
+
+        Assignment(Symbol id, Symbol type, Expression* rhs, Span span) : id(id), type(type), rhs(rhs), Statement(NodeKind::Assignment, span) {};
+        void toJSON(JsonWriter& out) override;
+        uint32_t flatten(FlatAst& flat) override;
         // llvm::Value *codegen() override;
 };
 
 class IfStatement : public Statement
 {
-    std::unique_ptr<Expression> conditional;
-    std::unique_ptr<StatementBlock> ifBlock;
-    std::unique_ptr<StatementBlock> elseBlock;
     public:
-        IfStatement(std::unique_ptr<Expression> conditional, std::unique_ptr<StatementBlock> ifBlock, std::unique_ptr<StatementBlock> elseBlock, Span span) : conditional(std::move(conditional)), ifBlock(std::move(ifBlock)), elseBlock(std::move(elseBlock)), Statement(span) {};
-        std::string toJSON(int lvl) override;
+        Expression* conditional;
+        StatementBlock* ifBlock;
+        StatementBlock* elseBlock;
+
+        IfStatement(Expression* conditional, StatementBlock* ifBlock, StatementBlock* elseBlock, Span span) : conditional(conditional), ifBlock(ifBlock), elseBlock(elseBlock), Statement(NodeKind::IfStatement, span) {};
+        void toJSON(JsonWriter& out) override;
+        uint32_t flatten(FlatAst& flat) override;
         // llvm::Value *codegen() override;
 };
 
@@ -177,38 +247,46 @@ class IfStatement : public Statement
 
 class NumericLiteral : public Value
 {
-    double value;
     public:
-        NumericLiteral(double value, Span span) : value(value), Value(span) {};
-        std::string toJSON(int lvl) override;
+        double value;
+
+        NumericLiteral(double value, Span span) : value(value), Value(NodeKind::NumericLiteral, span) {};
+        void toJSON(JsonWriter& out) override;
+        uint32_t flatten(FlatAst& flat) override;
         // llvm::Value *codegen() override;
 };
 
 class BooleanLiteral: public Value
 {
-    bool value;
     public:
-        BooleanLiteral(bool value, Span span) : value(value), Value(span) {};
-        std::string toJSON(int lvl) override;  
+        bool value;
+
+        BooleanLiteral(bool value, Span span) : value(value), Value(NodeKind::BooleanLiteral, span) {};
+        void toJSON(JsonWriter& out) override;
+        uint32_t flatten(FlatAst& flat) override;
         // llvm::Value *codegen() override;
 };
 
 class StringLiteral: public Iterable
 {
-    std::string value;
     public:
-        StringLiteral(std::string value, Span span) : value(value), Iterable(span) {};
-        std::string toJSON(int lvl) override;
+        std::string_view value;
+
+        StringLiteral(std::string_view value, Span span) : value(value), Iterable(NodeKind::StringLiteral, span) {};
+        void toJSON(JsonWriter& out) override;
+        uint32_t flatten(FlatAst& flat) override;
         // llvm::Value *codegen() override;
 
 };
 
 class IterableLiteral: public Iterable
 {
-    std::vector<std::unique_ptr<Expression>> value;
     public:
-        IterableLiteral(std::vector<std::unique_ptr<Expression>> value, Span span) : value(std::move(value)), Iterable(span) {};
-        std::string toJSON(int lvl) override;
+        ArenaArray<Expression*> value;
+
+        IterableLiteral(ArenaArray<Expression*> value, Span span) : value(value), Iterable(NodeKind::IterableLiteral, span) {};
+        void toJSON(JsonWriter& out) override;
+        uint32_t flatten(FlatAst& flat) override;
         // llvm::Value *codegen() override;
 };
 
@@ -216,23 +294,25 @@ class IterableLiteral: public Iterable
 
 class Subscription : public Value
 {
-    std::unique_ptr<Identifier> id;
-    std::unique_ptr<Expression> index;
-    
     public:
-        Subscription(std::unique_ptr<Identifier> id, std::unique_ptr<Expression> index, Span span) : id(std::move(id)), index(std::move(index)), Value(span) {};
-        std::string toJSON(int lvl) override;
+        Identifier* id;
+        Expression* index;
+
+        Subscription(Identifier* id, Expression* index, Span span) : id(id), index(index), Value(NodeKind::Subscription, span) {};
+        void toJSON(JsonWriter& out) override;
+        uint32_t flatten(FlatAst& flat) override;
         // llvm::Value *codegen() override;
 };
 
 class AttributeReference : public Value
 {
-    std::unique_ptr<Identifier> object;
-    std::unique_ptr<Value> attribute;
-
     public:
-        AttributeReference(std::unique_ptr<Identifier> object, std::unique_ptr<Value> attribute, Span span) : object(std::move(object)), attribute(std::move(attribute)), Value(span) {};
-        std::string toJSON(int lvl) override;
+        Identifier* object;
+        Value* attribute;
+
+        AttributeReference(Identifier* object, Value* attribute, Span span) : object(object), attribute(attribute), Value(NodeKind::AttributeReference, span) {};
+        void toJSON(JsonWriter& out) override;
+        uint32_t flatten(FlatAst& flat) override;
         // llvm::Value *codegen() override;
 };
 
@@ -240,42 +320,53 @@ class AttributeReference : public Value
 
 class Slice : public Iterable
 {
-    std::unique_ptr<Identifier> id;
-    std::unique_ptr<Expression> start;
-    std::unique_ptr<Expression> stop;
     public:
-        Slice(std::unique_ptr<Identifier> id, std::unique_ptr<Expression> start, std::unique_ptr<Expression> stop, Span span) : id(std::move(id)), start(std::move(start)), stop(std::move(stop)), Iterable(span) {};
-        std::string toJSON(int lvl) override;
+        Identifier* id;
+        Expression* start;
+        Expression* stop;
+
+        Slice(Identifier* id, Expression* start, Expression* stop, Span span) : id(id), start(start), stop(stop), Iterable(NodeKind::Slice, span) {};
+        void toJSON(JsonWriter& out) override;
+        uint32_t flatten(FlatAst& flat) override;
         // llvm::Value *codegen() override;
 };
 
 class List : public Iterable
 {
-   std::vector<std::string> elements;
-   public:
-        List(std::vector<std::string> elements, Span span) : elements(elements), Iterable(span) {};
-        std::string toJSON(int lvl) override;
+    public:
+        ArenaArray<std::string_view> elements;
+
+        List(ArenaArray<std::string_view> elements, Span span) : elements(elements), Iterable(NodeKind::List, span) {};
+        void toJSON(JsonWriter& out) override;
+        uint32_t flatten(FlatAst& flat) override;
         // llvm::Value *codegen() override;
 };      
 
 class Set : public Iterable
 {
-    std::vector<double> elements;
-    TypeDef Type;
-    public: 
-        Set(std::vector<double> elements, TypeDef type, Span span) : elements(elements), Type(type), Iterable(span) {};
-        std::string toJSON(int lvl) override;
+    public:
+        ArenaArray<double> elements;
+        TypeDef Type;
+
+        Set(ArenaArray<double> elements, TypeDef type, Span span) : elements(elements), Type(type), Iterable(NodeKind::Set, span) {};
+        void toJSON(JsonWriter& out) override;
+        uint32_t flatten(FlatAst& flat) override;
         // llvm::Value *codegen() override;
 };  
 
 class Generator : public Iterable
 {
-    std::unique_ptr<Expression> start;
-    std::unique_ptr<Expression> step;
-    std::unique_ptr<Expression> stop;
     public:
-         Generator(std::unique_ptr<Expression> start, std::unique_ptr<Expression> step, std::unique_ptr<Expression> stop, Span span) : start(std::move(start)), stop(std::move(stop)), step(std::move(step)), Iterable(span) {};
-         std::string toJSON(int lvl) override;
+        Expression* start;
+        Expression* step;
+        Expression* stop;
+        // its numbers, once folding has found its bounds to be literals where
+        // a loop or comprehension iterates it
+        std::optional<Range> range;
+
+         Generator(Expression* start, Expression* step, Expression* stop, Span span) : start(start), stop(stop), step(step), Iterable(NodeKind::Generator, span) {};
+         void toJSON(JsonWriter& out) override;
+         uint32_t flatten(FlatAst& flat) override;
          // llvm::Value *codegen() override;
 };
 
@@ -286,42 +377,47 @@ class Generator : public Iterable
 
 class BinaryExpression: public Expression
 {
-    std::unique_ptr<Expression> lhs;
-    std::unique_ptr<Expression> rhs;
-    std::string op;
     public:
-        BinaryExpression(std::unique_ptr<Expression> lhs, std::unique_ptr<Expression> rhs, std::string op, Span span) : lhs(std::move(lhs)), rhs(std::move(rhs)), op(op), Expression(span) {};
-        std::string toJSON(int lvl) override;
+        // first, where it fits in the padding after Node's kind
+        Operator op;
+        Expression* lhs;
+        Expression* rhs;
+
+        BinaryExpression(Expression* lhs, Expression* rhs, Operator op, Span span) : lhs(lhs), rhs(rhs), op(op), Expression(NodeKind::BinaryExpression, span) {};
+        void toJSON(JsonWriter& out) override;
+        uint32_t flatten(FlatAst& flat) override;
         // llvm::Value *codegen() override;
 };
 
 class BooleanExpression: public BinaryExpression
 {
     public:
-        BooleanExpression(std::unique_ptr<Expression> lhs, std::unique_ptr<Expression> rhs, std::string op, Span span) : BinaryExpression(std::move(lhs), std::move(rhs), op, span) {};
-        std::string toJSON(int lvl) override { return "should not happen";};
+        BooleanExpression(Expression* lhs, Expression* rhs, Operator op, Span span) : BinaryExpression(lhs, rhs, op, span) {};
 };
 
 class ListComprehension: public Iterable
 {
-    std::unique_ptr<Expression> body;
-    std::vector<std::unique_ptr<Identifier>> ids;
-    std::unique_ptr<Value> iterable;
-    std::unique_ptr<Expression> filter;
     public:
-        ListComprehension(std::unique_ptr<Expression> body, std::vector<std::unique_ptr<Identifier>> ids, std::unique_ptr<Value> iterable, std::unique_ptr<Expression> filter, Span span) : body(std::move(body)), ids(std::move(ids)), iterable(std::move(iterable)), filter(std::move(filter)), Iterable(span) {};
-        std::string toJSON(int lvl) override;
+        Expression* body;
+        ArenaArray<Identifier*> ids;
+        Value* iterable;
+        Expression* filter;
+
+        ListComprehension(Expression* body, ArenaArray<Identifier*> ids, Value* iterable, Expression* filter, Span span) : body(body), ids(ids), iterable(iterable), filter(filter), Iterable(NodeKind::ListComprehension, span) {};
+        void toJSON(JsonWriter& out) override;
+        uint32_t flatten(FlatAst& flat) override;
         // llvm::Value *codegen() override;
 };
 
 class FunctionCall: public Expression
 {
-     std::string id;
-     std::vector<std::unique_ptr<Expression>> args;
+    public:
+        Symbol id;
+        ArenaArray<Expression*> args;
 
-     public:
-        FunctionCall(const std::string id, std::vector<std::unique_ptr<Expression>> args, Span span) : id(id), args(std::move(args)), Expression(span) {};
-        std::string toJSON(int lvl) override;
+        FunctionCall(Symbol id, ArenaArray<Expression*> args, Span span) : id(id), args(args), Expression(NodeKind::FunctionCall, span) {};
+        void toJSON(JsonWriter& out) override;
+        uint32_t flatten(FlatAst& flat) override;
         // llvm::Value *codegen() override;
 };
 
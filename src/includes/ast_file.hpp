@@ -0,0 +1,56 @@
+#pragma once
+
+#ifndef AST_FILE_HPP
+#define AST_FILE_HPP
+
+#include <cstdint>
+#include <string>
+#include "flat_ast.hpp"
+
+// Binary AST files hold a FlatAst's arrays exactly as they sit in memory, so a
+// mapped file can be traversed through an AstView without decoding it.
+//
+// The header is followed by the kinds, spans, child ranges, payload ranges,
+// children, numbers, string ranges and string bytes, each starting on an
+// 8 byte boundary. Files are only read back on a host of the same byte order.
+
+const uint32_t ast_file_version = 1;
+
+struct AstFileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t nodeCount;
+    uint32_t childCount;
+    uint32_t numberCount;
+    uint32_t stringCount;
+    uint32_t stringBytes;
+    uint32_t reserved;
+};
+
+// writes through a temporary file and a rename, so readers never see half a file
+void writeAstFile(const FlatAst& ast, const std::string& path);
+
+// A binary AST file mapped read-only. Opening checks the header and that
+// every index in the file is in range, so traversals need no checks of their own.
+class AstFile
+{
+    const char* data;
+    size_t size;
+    AstView ast;
+
+    AstFile() : data(nullptr), size(0), ast() {};
+
+    public:
+        static AstFile open(const std::string& path);
+
+        AstFile(AstFile&& other);
+        AstFile(const AstFile&) = delete;
+        AstFile& operator=(const AstFile&) = delete;
+        ~AstFile();
+
+        const AstView& view() const { return ast; };
+};
+
+#endif
@@ -0,0 +1,53 @@
+#pragma once
+
+#ifndef CACHE_HPP
+#define CACHE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include "ast_file.hpp"
+
+// bump whenever the parser would build a different tree from the same source,
+// so stale entries stop matching
+const uint32_t parser_version = 2;
+
+// fast non-cryptographic hash, eight bytes at a time
+uint64_t hashBytes(std::string_view bytes, uint64_t seed);
+
+// Binary AST files in a directory, named after a hash of the source they were
+// parsed from, salted with the parser and file format versions. Hits refresh
+// the file's modification time, and trim() removes the least recently used
+// files until the directory fits its size limit.
+class ParseCache
+{
+    std::string directory;
+    uint64_t limit;
+    // set when the trees stored differ from the parser's, say folded ones,
+    // so that they are kept apart from plain parses of the same source
+    std::string variant;
+    // safe to share between threads, find and store only touch whole files
+    std::atomic<uint64_t> hitCount;
+    std::atomic<uint64_t> missCount;
+    std::atomic<uint64_t> evictionCount;
+
+    std::string path(std::string_view source) const;
+
+    public:
+        ParseCache(std::string directory, uint64_t limit, std::string variant = "");
+
+        // the stored parse of this exact source, if there is one
+        std::optional<AstFile> find(std::string_view source);
+
+        void store(std::string_view source, const FlatAst& ast);
+
+        void trim();
+
+        uint64_t hits() const { return hitCount; };
+        uint64_t misses() const { return missCount; };
+        uint64_t evictions() const { return evictionCount; };
+};
+
+#endif
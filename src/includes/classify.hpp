@@ -0,0 +1,178 @@
+#pragma once
+
+#ifndef CLASSIFY_HPP
+#define CLASSIFY_HPP
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include "token.hpp"
+
+// Character and lexeme classification for the lexer, all resolved at compile
+// time. Lookups that find nothing return TokenType::ID.
+
+enum class CharClass : uint8_t
+{
+    OTHER,
+    BLANK,
+    ALPHA,
+    DIGIT,
+    QUOTE,
+    OPERATOR,
+    COMMENT,
+};
+
+constexpr std::array<CharClass, 256> char_classes = []
+{
+    std::array<CharClass, 256> table = {};
+    for (int c = 'a'; c <= 'z'; c++)
+    {
+        table[c] = CharClass::ALPHA;
+        table[c - 'a' + 'A'] = CharClass::ALPHA;
+    }
+    for (int c = '0'; c <= '9'; c++)
+    {
+        table[c] = CharClass::DIGIT;
+    }
+    for (unsigned char c : std::string_view("+-*/^%=:,.()[]{}<>!"))
+    {
+        table[c] = CharClass::OPERATOR;
+    }
+    table[' '] = CharClass::BLANK;
+    table['\t'] = CharClass::BLANK;
+    table['"'] = CharClass::QUOTE;
+    table['\''] = CharClass::QUOTE;
+    table['#'] = CharClass::COMMENT;
+    return table;
+}();
+
+constexpr CharClass char_class(char c)
+{
+    return char_classes[(unsigned char)c];
+}
+
+constexpr TokenType single_operator(char c)
+{
+    switch (c)
+    {
+        case '+': return TokenType::PLUS;
+        case '-': return TokenType::MINUS;
+        case '*': return TokenType::MULT;
+        case '/': return TokenType::DIV;
+        case '^': return TokenType::EXPO;
+        case '%': return TokenType::MODULO;
+        case '=': return TokenType::ASSIGN;
+        case ':': return TokenType::TYPE_DECL;
+        case ',': return TokenType::COMMA;
+        case '.': return TokenType::PERIOD;
+        case '(': return TokenType::LPAREN;
+        case ')': return TokenType::RPAREN;
+        case '[': return TokenType::LSQUARE;
+        case ']': return TokenType::RSQUARE;
+        case '{': return TokenType::LCURLY;
+        case '}': return TokenType::RCURLY;
+        case '>': return TokenType::MORE_THAN;
+        case '<': return TokenType::LESS_THAN;
+        default: return TokenType::ID;
+    }
+}
+
+constexpr TokenType double_operator(char first, char second)
+{
+    if (second == '=')
+    {
+        switch (first)
+        {
+            case '=': return TokenType::EQUIVALENCE;
+            case '!': return TokenType::NOT_EQUAL;
+            case '>': return TokenType::MORE_EQUAL;
+            case '<': return TokenType::LESS_EQUAL;
+            case '+': return TokenType::INCREMENT;
+            case '-': return TokenType::DECREMENT;
+        }
+    }
+    else if (first == '.' && second == '.')
+    {
+        return TokenType::ELIPSIS;
+    }
+    return TokenType::ID;
+}
+
+// switches on length and first character, leaving one or two comparisons
+constexpr TokenType keyword(std::string_view word)
+{
+    switch (word.size())
+    {
+        case 2:
+            switch (word[0])
+            {
+                case 'i':
+                    if (word == "if") return TokenType::IF;
+                    if (word == "in") return TokenType::IN;
+                    break;
+                case 'o':
+                    if (word == "or") return TokenType::OR;
+                    break;
+            }
+            break;
+        case 3:
+            switch (word[0])
+            {
+                case 'f':
+                    if (word == "for") return TokenType::FOR;
+                    break;
+                case 'a':
+                    if (word == "and") return TokenType::AND;
+                    break;
+                case 'n':
+                    if (word == "not") return TokenType::NOT;
+                    break;
+            }
+            break;
+        case 4:
+            switch (word[0])
+            {
+                case 'e':
+                    if (word == "else") return TokenType::ELSE;
+                    break;
+                case 't':
+                    if (word == "true") return TokenType::BOOL;
+                    break;
+                case 'n':
+                    if (word == "null") return TokenType::NONE;
+                    break;
+            }
+            break;
+        case 5:
+            switch (word[0])
+            {
+                case 'w':
+                    if (word == "while") return TokenType::WHILE;
+                    break;
+                case 'f':
+                    if (word == "false") return TokenType::BOOL;
+                    break;
+                case 'c':
+                    if (word == "class") return TokenType::CLASS;
+                    break;
+            }
+            break;
+        case 6:
+            switch (word[0])
+            {
+                case 'r':
+                    if (word == "return") return TokenType::RETURN;
+                    break;
+                case 's':
+                    if (word == "struct") return TokenType::STRUCT;
+                    break;
+            }
+            break;
+    }
+    return TokenType::ID;
+}
+
+static_assert(keyword("while") == TokenType::WHILE && keyword("whale") == TokenType::ID);
+static_assert(double_operator('.', '.') == TokenType::ELIPSIS && double_operator('=', '>') == TokenType::ID);
+
+#endif
@@ -0,0 +1,73 @@
+#pragma once
+
+#ifndef DOCUMENT_HPP
+#define DOCUMENT_HPP
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "ast.hpp"
+#include "source.hpp"
+#include "token.hpp"
+
+// A source kept lexed and parsed across edits, for editors. The text is cut
+// into pieces, one per top-level statement, each running from its statement's
+// first line up to the next one's. Every piece begins at indentation level 0,
+// so an edit only re-lexes the pieces it touches: the indent stack is back in
+// step where the next untouched piece begins. Only the statements in those
+// lines are parsed again, the others keep their trees and have their tokens
+// and spans moved along. Statements that do not lex or parse are left out of
+// the program, with their errors kept until an edit fixes them.
+class Document
+{
+    struct Piece
+    {
+        // offset of the piece's first line
+        uint32_t start;
+        size_t tokenCount;
+        Arena arena;
+        std::vector<Statement*> statements;
+        std::string error;
+    };
+
+    std::string buffer;
+    Source lines;
+    // the whole text's tokens, ending in EoF
+    std::vector<Token> lexed;
+    std::vector<Piece> pieces;
+    // shared by every piece's parse, it keeps the names of edits past too
+    std::shared_ptr<SymbolTable> symbols;
+    std::unique_ptr<Program> tree;
+    size_t relexCount;
+    size_t reparseCount;
+
+    size_t pieceAt(size_t offset) const;
+    void update(size_t first, size_t last, uint32_t start, uint32_t end, uint32_t oldEnd, int64_t delta);
+    void parse(Piece& piece, size_t firstToken);
+
+    public:
+        Document(std::string text);
+        // the Source points into the buffer
+        Document(const Document&) = delete;
+        Document& operator=(const Document&) = delete;
+
+        // replaces the length bytes at offset with replacement
+        void edit(size_t offset, size_t length, std::string_view replacement);
+
+        std::string_view text() const { return buffer; };
+        const Source& source() const { return lines; };
+        const std::vector<Token>& tokens() const { return lexed; };
+
+        // the statements that parsed, valid until the next edit
+        Program& program() const { return *tree; };
+
+        // one per statement that did not lex or parse, with its first line
+        std::vector<std::string> errors() const;
+
+        // how much the last edit redid
+        size_t relexedLines() const { return relexCount; };
+        size_t reparsedStatements() const { return reparseCount; };
+};
+
+#endif
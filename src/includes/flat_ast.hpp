@@ -0,0 +1,172 @@
+#pragma once
+
+#ifndef FLAT_AST_HPP
+#define FLAT_AST_HPP
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "ast.hpp"
+
+// A Program flattened into parallel arrays, for passes that want to walk the
+// whole tree as a scan over contiguous memory rather than by chasing pointers.
+//
+// Nodes are numbered in pre-order, so the Program is node 0 and every node
+// comes before its children. Each node has a kind, a span, a range of child
+// node indices and a range into one of the side tables for its literal data:
+//
+//   Program, StatementBlock   children: statements
+//   Parameter                 strings: id, type
+//   FunctionPrototype         children: params             strings: name, return_type
+//   FunctionDefenition        children: prototype, body
+//   ReturnStatement           children: expression
+//   ForLoop                   children: ids..., iterable, body
+//   WhileLoop                 children: condition, body
+//   Assignment                children: rhs                strings: id, type
+//   IfStatement               children: condition, if block, else block
+//   Identifier                strings: value
+//   NumericLiteral            numbers: value
+//   BooleanLiteral            payload.first is the value
+//   StringLiteral             strings: value
+//   IterableLiteral           children: values
+//   Subscription              children: id, index
+//   AttributeReference        children: object, attribute
+//   Slice                     children: id, start, stop
+//   List                      strings: elements
+//   Set                       numbers: element type, elements...
+//   Generator                 children: start, step, stop
+//   BinaryExpression          children: lhs, rhs           strings: op
+//   ListComprehension         children: body, iterable, filter, ids...
+//   FunctionCall              children: args               strings: id
+class AstView;
+
+class FlatAst
+{
+    public:
+        struct Range
+        {
+            uint32_t first;
+            uint32_t count;
+        };
+
+        template <typename T>
+        struct View
+        {
+            const T* first;
+            uint32_t count;
+
+            const T* begin() const { return first; };
+            const T* end() const { return first + count; };
+            uint32_t size() const { return count; };
+            const T& operator[](uint32_t i) const { return first[i]; };
+        };
+
+        // per node
+        std::vector<NodeKind> kinds;
+        std::vector<Span> spans;
+        std::vector<Range> childRanges;
+        std::vector<Range> payloads;
+
+        // side tables
+        std::vector<uint32_t> children;
+        std::vector<double> numbers;
+        std::vector<Range> strings; // into stringData
+        std::string stringData; // each distinct string once
+
+        FlatAst() { this->operatorOffsets.fill(UINT32_MAX); };
+        FlatAst(Program& program);
+
+        uint32_t size() const { return kinds.size(); };
+
+        AstView view() const;
+
+        View<uint32_t> childrenOf(uint32_t node) const;
+
+        View<double> numbersOf(uint32_t node) const;
+
+        std::string_view string(uint32_t index) const;
+
+        // used by Node::flatten
+
+        uint32_t add(NodeKind kind, Span span);
+
+        uint32_t addString(std::string_view text);
+
+        // the same for a name of the flattened Program's symbol table
+        uint32_t addSymbol(Symbol symbol);
+
+        // and for an operator, as written in the source
+        uint32_t addOperator(Operator op);
+
+        uint32_t addNumber(double value);
+
+        void setPayload(uint32_t node, uint32_t first, uint32_t count);
+
+        size_t openChildren() const { return pending.size(); };
+
+        void child(uint32_t node) { pending.push_back(node); };
+
+        void closeChildren(uint32_t node, size_t mark);
+
+    private:
+        // children of the nodes being flattened, moved into children once a
+        // node's list is complete so each list ends up contiguous
+        std::vector<uint32_t> pending;
+        // where each distinct string starts in stringData
+        std::unordered_map<std::string, uint32_t> interned;
+        // and where each symbol's name does, once it has been looked up
+        const SymbolTable* symbols = nullptr;
+        std::vector<uint32_t> symbolOffsets;
+        std::array<uint32_t, operator_count> operatorOffsets;
+
+        uint32_t intern(std::string_view text);
+};
+
+// Read-only access to a flat AST's arrays wherever they live, in a FlatAst or
+// in a mapped binary AST file, with the same encoding as FlatAst.
+class AstView
+{
+    public:
+        uint32_t nodeCount;
+        const NodeKind* kinds;
+        const Span* spans;
+        const FlatAst::Range* childRanges;
+        const FlatAst::Range* payloads;
+        const uint32_t* children;
+        const double* numbers;
+        const FlatAst::Range* strings;
+        const char* stringData;
+
+        uint32_t size() const { return nodeCount; };
+
+        NodeKind kind(uint32_t node) const { return kinds[node]; };
+
+        Span span(uint32_t node) const { return spans[node]; };
+
+        FlatAst::Range payload(uint32_t node) const { return payloads[node]; };
+
+        FlatAst::View<uint32_t> childrenOf(uint32_t node) const
+        {
+            return {children + childRanges[node].first, childRanges[node].count};
+        };
+
+        FlatAst::View<double> numbersOf(uint32_t node) const
+        {
+            return {numbers + payloads[node].first, payloads[node].count};
+        };
+
+        std::string_view string(uint32_t index) const
+        {
+            return {stringData + strings[index].first, strings[index].count};
+        };
+};
+
+class JsonWriter;
+
+// writes the same JSON as Program::toJSON from the flat form
+void writeJSON(const AstView& ast, JsonWriter& out);
+
+#endif
@@ -0,0 +1,23 @@
+#pragma once
+
+#ifndef FOLD_HPP
+#define FOLD_HPP
+
+#include <cstdint>
+#include "ast.hpp"
+
+// bump whenever folding would give a different tree from the same parse, so
+// cached folded trees stop matching
+const uint32_t fold_version = 4;
+
+// Replaces binary expressions whose operands are literals with the literal
+// they evaluate to, and drops identities like x * 1 and x + 0 where x is sure
+// to be a number, bottom up so that whole constant trees collapse. Arithmetic
+// and comparisons fold over numbers, and, or and the comparisons over
+// booleans, and in over generators with literal bounds, see range.hpp.
+// Division by zero and results that are not finite are left for later passes
+// to report. Generators that loops and comprehensions iterate get their range
+// when their bounds are literals. Returns how many nodes were removed.
+uint64_t foldConstants(Program& program);
+
+#endif
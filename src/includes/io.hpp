@@ -4,9 +4,32 @@
 #define IO_HPP
 
 #include <string>
-#include <vector>
-#include <sstream>
+#include <string_view>
 
-std::vector<std::string> split(std::string s, std::string delimiter);
+// The bytes of an input file. Regular files are memory mapped read-only, so
+// the only pass over them is the lexer's. Anything that cannot be mapped
+// (pipes, stdin, empty files) is read once into an owned buffer.
+class SourceFile
+{
+    const char* data;
+    size_t size;
+    bool mapped;
+    std::string buffer;
 
-#endif
\ No newline at end of file
+    SourceFile() : data(nullptr), size(0), mapped(false) {};
+
+    public:
+        // "-" reads standard input
+        static SourceFile open(const std::string& path);
+
+        SourceFile(SourceFile&& other);
+        SourceFile(const SourceFile&) = delete;
+        SourceFile& operator=(const SourceFile&) = delete;
+        ~SourceFile();
+
+        std::string_view view() const { return {data, size}; };
+
+        bool isMapped() const { return mapped; };
+};
+
+#endif
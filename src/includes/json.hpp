@@ -0,0 +1,59 @@
+#pragma once
+
+#ifndef JSON_HPP
+#define JSON_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "symbols.hpp"
+
+// Streams JSON into a buffer in one pass, keeping track of commas and
+// indentation itself. With a file descriptor the buffer is written out
+// whenever it fills up and by flush(), otherwise it grows and holds the whole
+// document. Pretty output indents with tabs, compact output has no whitespace.
+class JsonWriter
+{
+    std::string buffer;
+    int fd;
+    size_t flushed;
+    bool pretty;
+    // per open object or array, whether it is still empty
+    std::vector<bool> empty;
+    bool afterKey;
+    const SymbolTable* symbols;
+
+    void separate();
+    void newline();
+    void quoted(std::string_view text);
+
+    public:
+        JsonWriter(bool pretty = true) : fd(-1), flushed(0), pretty(pretty), afterKey(false), symbols(nullptr) {};
+        JsonWriter(int fd, bool pretty = true) : fd(fd), flushed(0), pretty(pretty), afterKey(false), symbols(nullptr) {};
+
+        void beginObject();
+        void endObject();
+        void beginArray();
+        void endArray();
+
+        void key(std::string_view name);
+
+        void string(std::string_view value);
+        void number(double value);
+        void boolean(bool value);
+
+        // symbols are written as the names they stand for in this table
+        void useSymbols(const SymbolTable* table) { symbols = table; };
+        void symbol(Symbol value) { string(symbols->name(value)); };
+
+        // writes anything buffered to the file descriptor
+        void flush();
+
+        // the document so far, when there is no file descriptor
+        const std::string& str() const { return buffer; };
+
+        // bytes of output so far, written out or still buffered
+        size_t size() const { return flushed + buffer.size(); };
+};
+
+#endif
@@ -5,81 +5,89 @@
 
 #include <string>
 #include <vector>
-#include <tuple>
-#include <map>
-#include "io.hpp"
+#include <string_view>
 #include "token.hpp"
+#include "source.hpp"
+#include "classify.hpp"
+#include "scan.hpp"
+#include "pool.hpp"
 
 class Lexer
 {
     std::vector<Token> tokens;
-    std::string content;
-    int lineNumber;
-    int columnNumber;
-    std::string line;
-    int cursor;
+    Source& source;
+    std::string_view content;
+    // bounds of the line currently being tokenized, as offsets into content
+    size_t lineStart;
+    size_t lineEnd;
+    size_t cursor;
     char character;
-    int level;
-    std::map<std::string, TokenType> keywords =
-        {
-            {"if", TokenType::IF},
-            {"else", TokenType::ELSE},
-            {"for", TokenType::FOR},
-            {"in", TokenType::IN},
-            {"while", TokenType::WHILE},
-            {"return", TokenType::RETURN},
-            {"true", TokenType::BOOL},
-            {"false", TokenType::BOOL},
-            {"null", TokenType::NONE},
-            {"and", TokenType::AND},
-            {"or", TokenType::OR},
-            {"not", TokenType::NOT},
-            {"class", TokenType::CLASS},
-            {"struct", TokenType::STRUCT}
-        };
-
-    std::map<std::string, TokenType> double_operators =
-        {
-            {"==", TokenType::EQUIVALENCE},
-            {"!=", TokenType::NOT_EQUAL},
-            {">=", TokenType::MORE_EQUAL},
-            {"<=", TokenType::LESS_EQUAL},
-            {"+=", TokenType::INCREMENT},
-            {"-=", TokenType::DECREMENT},
-            {"..", TokenType::ELIPSIS}
-        };
-
-    std::map<char, TokenType> single_operators =
-        {
-            {'+', TokenType::PLUS},
-            {'-', TokenType::MINUS},
-            {'*', TokenType::MULT},
-            {'/', TokenType::DIV},
-            {'^', TokenType::EXPO},
-            {'%', TokenType::MODULO},
-            {'=', TokenType::ASSIGN},
-            {':', TokenType::TYPE_DECL},
-            {',', TokenType::COMMA},
-            {'.', TokenType::PERIOD},
-            {'(', TokenType::LPAREN},
-            {')', TokenType::RPAREN},
-            {'[', TokenType::LSQUARE},
-            {']', TokenType::RSQUARE},
-            {'{', TokenType::LCURLY},
-            {'}', TokenType::RCURLY},
-            {'>', TokenType::MORE_THAN},
-            {'<', TokenType::LESS_THAN}
-        };
-    
+    // columns a tab advances to, and the indentation widths of the open blocks
+    int tabWidth;
+    std::vector<int> indents;
+
+    // Set while lexing one chunk of a parallel init. Lines then leave their
+    // indentation in marks instead of emitting INDENT and DEDENT, and their
+    // starts in lineStarts instead of the Source, both resolved in order when
+    // the chunks are merged.
+    struct IndentMark
+    {
+        size_t token;
+        int width;
+        uint32_t offset;
+        uint32_t line;
+    };
+    bool chunked;
+    std::vector<IndentMark> marks;
+    std::vector<uint32_t> lineStarts;
+
+    // where next() carries on, whether it has ended the tokens with EoF, and
+    // how many tokens it has returned
+    size_t streamed;
+    bool ended;
+    size_t streamedTokens;
+
 public:
-    Lexer(std::string content);
+    Lexer(Source& source, int tabWidth = 4);
 
     std::vector<Token> init();
 
+    // the same tokens, with large inputs lexed in chunks on the pool
+    std::vector<Token> init(ThreadPool& pool);
+
+    // the same tokens, lexed in chunks on the pool that are cut at the given
+    // offsets, each just after a newline and in increasing order
+    std::vector<Token> init(ThreadPool& pool, const std::vector<size_t>& cuts);
+
+    // On a fresh lexer, the tokens of the whole lines in [start, end) alone,
+    // as if a top-level statement began at start and the input ended at end.
+    // The Source's lines are left as they are, errors number the lines from
+    // after linesBefore.
+    std::vector<Token> relex(size_t start, size_t end, int linesBefore);
+
+    // For streaming, the tokens of the next whole lines, at least count of
+    // them until the input runs out, then its DEDENTs and EoF and after those
+    // nothing. Valid until the next call.
+    const std::vector<Token>& next(size_t count);
+
+    size_t tokensStreamed() const { return streamedTokens; };
+
 private:
+    void lexLines(size_t start, size_t end);
+
+    void close(size_t end);
+
+    void replay(const Lexer& chunk, int linesBefore);
+
     void advance();
 
-    void goBack();
+    void seek(const char* position);
+
+    int measureIndent();
+
+    void indent(int width);
+
+    void resolve(int width, int line);
 
     Token collect_identifier();
 
@@ -87,9 +95,9 @@ private:
 
     Token collect_string(char close);
 
-    std::string characterAt(int index, int lookahead = 1);
+    Token make(TokenType type, size_t start, size_t end);
 
-    std::tuple<std::vector<Token>, int> tokenize(std::string line, int level);
+    void tokenize(size_t start, size_t end);
 };
 
 #endif 
\ No newline at end of file
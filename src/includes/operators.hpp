@@ -0,0 +1,111 @@
+#pragma once
+
+#ifndef OPERATORS_HPP
+#define OPERATORS_HPP
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include "token.hpp"
+
+// Binary operators, resolved from the token type at compile time so that
+// expression parsing never looks at an operator's text.
+
+enum class Operator : uint8_t
+{
+    None,
+    Power,
+    Multiply,
+    Divide,
+    Add,
+    Subtract,
+    Equal,
+    NotEqual,
+    MoreEqual,
+    LessEqual,
+    More,
+    Less,
+    And,
+    Or,
+    Not,
+    In,
+};
+
+const size_t operator_count = 16;
+
+enum class Associativity : uint8_t
+{
+    Left,
+    Right,
+};
+
+struct OperatorInfo
+{
+    Operator op;
+    // higher binds tighter, tokens that are no binary operator have -1
+    int8_t precedence;
+    Associativity associativity;
+};
+
+constexpr std::array<OperatorInfo, 256> binary_operators = []
+{
+    std::array<OperatorInfo, 256> table = {};
+    for (OperatorInfo& info : table)
+    {
+        info = {Operator::None, -1, Associativity::Left};
+    }
+    auto set = [&](TokenType type, Operator op, int8_t precedence, Associativity associativity = Associativity::Left)
+    {
+        table[(size_t)type] = {op, precedence, associativity};
+    };
+    set(TokenType::EXPO, Operator::Power, 80, Associativity::Right);
+    set(TokenType::MULT, Operator::Multiply, 40);
+    set(TokenType::DIV, Operator::Divide, 40);
+    set(TokenType::PLUS, Operator::Add, 20);
+    set(TokenType::MINUS, Operator::Subtract, 20);
+    set(TokenType::AND, Operator::And, 12);
+    set(TokenType::OR, Operator::Or, 12);
+    set(TokenType::NOT, Operator::Not, 12);
+    set(TokenType::IN, Operator::In, 12);
+    set(TokenType::EQUIVALENCE, Operator::Equal, 10);
+    set(TokenType::NOT_EQUAL, Operator::NotEqual, 10);
+    set(TokenType::MORE_EQUAL, Operator::MoreEqual, 10);
+    set(TokenType::LESS_EQUAL, Operator::LessEqual, 10);
+    set(TokenType::MORE_THAN, Operator::More, 10);
+    set(TokenType::LESS_THAN, Operator::Less, 10);
+    return table;
+}();
+
+constexpr const OperatorInfo& binary_operator(TokenType type)
+{
+    return binary_operators[(size_t)type];
+}
+
+// as written in the source
+constexpr std::string_view operator_text(Operator op)
+{
+    switch (op)
+    {
+        case Operator::Power: return "^";
+        case Operator::Multiply: return "*";
+        case Operator::Divide: return "/";
+        case Operator::Add: return "+";
+        case Operator::Subtract: return "-";
+        case Operator::Equal: return "==";
+        case Operator::NotEqual: return "!=";
+        case Operator::MoreEqual: return ">=";
+        case Operator::LessEqual: return "<=";
+        case Operator::More: return ">";
+        case Operator::Less: return "<";
+        case Operator::And: return "and";
+        case Operator::Or: return "or";
+        case Operator::Not: return "not";
+        case Operator::In: return "in";
+        default: return "";
+    }
+}
+
+static_assert(binary_operator(TokenType::MULT).precedence > binary_operator(TokenType::PLUS).precedence);
+static_assert(binary_operator(TokenType::ASSIGN).op == Operator::None && operator_text(Operator::LessEqual) == "<=");
+
+#endif
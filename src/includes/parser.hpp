@@ -4,50 +4,77 @@
 #define PARSER_HPP
 
 #include "lexer.hpp"
+#include "token_stream.hpp"
 #include "ast.hpp"
-#include <map>
+#include "source.hpp"
+#include "pool.hpp"
+#include <array>
+#include <memory>
+#include <string_view>
 
 class Parser
 {
-    std::vector<Token> tokens;
-    int index;
+    TokenStream stream;
+    const Source& source;
+    // every node is allocated here, then handed to the Program
+    Arena arena;
     Token current_token;
-    std::map<std::string, int> precedence_map = 
+    // names are interned into the compilation's table as nodes are built,
+    // through a cache of the ones seen last
+    std::shared_ptr<SymbolTable> symbols;
+    struct RecentSymbol
     {
-        {"^", 80},
-        {"*", 40},
-        {"/", 40},
-        {"+", 20},
-        {"-", 20},
-        {"==", 10},
-        {"!=", 10},
-        {">=", 10},
-        {"<=", 10},
-        {">", 10},
-        {"<", 10},
-        {"and", 12},
-        {"or", 12},
-        {"not", 12},
-        {"in", 12},
+        std::string_view text;
+        Symbol symbol;
     };
+    std::array<RecentSymbol, 256> recent;
+    // the items of the lists being parsed, nested lists above the ones they
+    // are in; a list is copied into the arena once complete, so after the
+    // first few statements building one allocates nothing
+    std::vector<Node*> pending;
 
     public:
 
-    Parser(std::vector<Token> tokens);
+    // without a symbol table the parser starts one of its own
+    Parser(std::vector<Token> tokens, const Source& source, std::shared_ptr<SymbolTable> symbols = nullptr);
+
+    // pulls the tokens from the lexer as it goes, rather than lexing first
+    Parser(Lexer& lexer, const Source& source, std::shared_ptr<SymbolTable> symbols = nullptr);
 
     std::unique_ptr<Program> parse();
 
+    // the same Program, with runs of top-level statements parsed on the pool;
+    // a parser pulling from a lexer has no runs to hand out and parses alone
+    std::unique_ptr<Program> parse(ThreadPool& pool);
+
+    // just the top-level statements, their nodes moved into the given arena
+    std::vector<Statement*> parse_top_level(Arena& into);
+
+    // token indices where a statement at indentation level 0 begins, other
+    // than the first; an else belongs to the if before it
+    static std::vector<size_t> top_level_starts(const std::vector<Token>& tokens);
+
     private:
 
     // utility
 
-    bool lookahead(std::vector<TokenType> tokens);
+    // whether the next tokens are types, in order
+    template <TokenType... types>
+    bool lookahead()
+    {
+        size_t i = 0;
+        return ((this->stream.peek(i++).type == types) && ...);
+    };
 
-    std::string consume(int repetition=1);
+    std::string_view consume(int repetition=1);
 
-    void check_and_consume(TokenType expected_token_type);
+    std::string_view text();
+
+    Symbol symbol(std::string_view text);
 
-    int check_precedence();
+    LineColumn position();
+
+    void check_and_consume(TokenType expected_token_type);
 
     bool check_if_func_def();
 
@@ -57,71 +84,93 @@ class Parser
 
     Span current_span();
 
+    size_t openList() const { return pending.size(); };
+
+    template <typename T>
+    ArenaArray<T*> closeList(size_t mark)
+    {
+        uint32_t count = this->pending.size() - mark;
+        if (count == 0)
+        {
+            return {};
+        }
+        T** items = (T**)this->arena.allocate(sizeof(T*) * count, alignof(T*));
+        for (uint32_t i = 0; i < count; i++)
+        {
+            items[i] = static_cast<T*>(this->pending[mark + i]);
+        }
+        this->pending.resize(mark);
+        return {items, count};
+    };
+
     // Statements
 
-    std::unique_ptr<StatementBlock> parse_statement_block();
+    StatementBlock* parse_statement_block();
+
+    std::vector<Statement*> parse_statements();
 
-    std::vector<std::unique_ptr<Statement>> parse_statements(TokenType end_token = TokenType::EoF);
+    // onto pending, up to end_token or EoF
+    void collect_statements(TokenType end_token);
     
-    std::unique_ptr<Statement> parse_statement();
+    Statement* parse_statement();
 
-    std::unique_ptr<Assignment> parse_assignment();
+    Assignment* parse_assignment();
 
-    std::unique_ptr<Statement> parse_return();
+    Statement* parse_return();
 
-    std::unique_ptr<FunctionDefenition> parse_function_defenition();
+    FunctionDefenition* parse_function_defenition();
 
-    std::unique_ptr<FunctionPrototype> parse_function_prototype();
+    FunctionPrototype* parse_function_prototype();
 
-    std::unique_ptr<Parameter> parse_parameter();
+    Parameter* parse_parameter();
 
-    std::unique_ptr<Statement> parse_return_statement();
+    Statement* parse_return_statement();
 
-    std::unique_ptr<IfStatement> parse_if_statement();
+    IfStatement* parse_if_statement();
 
-    std::unique_ptr<WhileLoop> parse_while_loop();
+    WhileLoop* parse_while_loop();
 
-    std::unique_ptr<ForLoop> parse_for_loop();
+    ForLoop* parse_for_loop();
 
     // Expressions
 
-    std::unique_ptr<Expression> parse_expression();
+    Expression* parse_expression();
 
-    std::unique_ptr<Expression> parse_primary();
+    Expression* parse_primary();
 
-    std::unique_ptr<Expression> parse_unary();
+    Expression* parse_unary();
 
-    std::unique_ptr<Expression> parse_parenthesis();
+    Expression* parse_parenthesis();
 
-    std::unique_ptr<FunctionCall> parse_function_call();
+    FunctionCall* parse_function_call();
 
-    std::unique_ptr<Expression> parse_binary_expression(int precedence, std::unique_ptr<Expression> lhs);
+    Expression* parse_binary_expression(int precedence, Expression* lhs);
 
-    std::unique_ptr<ListComprehension> parse_list_comprehension();
+    ListComprehension* parse_list_comprehension();
 
-    std::unique_ptr<Generator> parse_generator();
+    Generator* parse_generator();
 
-    std::unique_ptr<Iterable> parse_iterable();
+    Iterable* parse_iterable();
 
-    std::unique_ptr<Identifier> parse_identifier();
+    Identifier* parse_identifier();
 
-    std::unique_ptr<Slice> parse_iterable_slice();
+    Slice* parse_iterable_slice();
 
-    std::unique_ptr<Subscription> parse_iterable_subscription();
+    Subscription* parse_iterable_subscription();
 
-    std::unique_ptr<Value> parse_attribute_reference();
+    Value* parse_attribute_reference();
 
     // literals
 
-    std::unique_ptr<NumericLiteral> parse_numeric_literal();
+    NumericLiteral* parse_numeric_literal();
 
-    std::unique_ptr<BooleanLiteral> parse_boolean_literal();
+    BooleanLiteral* parse_boolean_literal();
 
-    std::unique_ptr<StringLiteral> parse_string_literal();
+    StringLiteral* parse_string_literal();
 
-    std::unique_ptr<List> parse_list();
+    List* parse_list();
 
-    std::unique_ptr<IterableLiteral> parse_literal_iterable();
+    IterableLiteral* parse_literal_iterable();
 
 
 };
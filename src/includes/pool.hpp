@@ -0,0 +1,77 @@
+#pragma once
+
+#ifndef POOL_HPP
+#define POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool. Every worker has its own deque: it pushes and
+// pops its own tasks at the back and, once it runs dry, steals from the
+// front of the others'. Threads that are not workers share one more deque.
+class ThreadPool
+{
+    struct Queue
+    {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+    std::atomic<size_t> queued;
+    std::atomic<bool> stopping;
+    std::mutex idleLock;
+    std::condition_variable wake;
+
+    unsigned self() const;
+    void work(unsigned index);
+
+    public:
+        // workers besides the threads that wait on tasks, which help run them
+        explicit ThreadPool(unsigned workers);
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+        ~ThreadPool();
+
+        void submit(std::function<void()> task);
+
+        // runs one queued task on the calling thread, if there is any
+        bool runOne();
+
+        unsigned workers() const { return threads.size(); };
+
+        // one thread per core, counting the one that waits
+        static unsigned defaultWorkers();
+};
+
+// Tasks submitted to a pool that can be waited on together. wait() runs
+// queued tasks while it waits, so groups can be waited on from inside tasks,
+// and rethrows the first exception any of the group's tasks threw.
+class TaskGroup
+{
+    ThreadPool& pool;
+    std::atomic<size_t> pending;
+    std::mutex lock;
+    std::condition_variable finished;
+    std::exception_ptr error;
+
+    public:
+        TaskGroup(ThreadPool& pool) : pool(pool), pending(0) {};
+        TaskGroup(const TaskGroup&) = delete;
+        TaskGroup& operator=(const TaskGroup&) = delete;
+        ~TaskGroup();
+
+        void run(std::function<void()> task);
+
+        void wait();
+};
+
+#endif
@@ -0,0 +1,65 @@
+#pragma once
+
+#ifndef RANGE_HPP
+#define RANGE_HPP
+
+#include <cstdint>
+#include <optional>
+#include "arena.hpp"
+#include "span.hpp"
+
+class Generator;
+class Set;
+
+// The numbers a generator like [1..100] or [1, 2..10] stands for, start to
+// stop inclusive in steps of step, held as its first number, step and length
+// rather than the numbers themselves. Length, membership and indexing are
+// worked out in closed form, and iterating computes each number as it goes,
+// so a range costs the same whatever its length. Only materialise() stores
+// the numbers, for when a program needs them as a Set.
+class Range
+{
+    double first;
+    double step;
+    uint64_t count;
+
+    Range(double first, double step, uint64_t count) : first(first), step(step), count(count) {};
+
+    public:
+        // how far from a whole number of steps a number may be and still be
+        // counted as on the range, for steps that are not exact in binary
+        static constexpr double tolerance = 1e-9;
+
+        class iterator
+        {
+            const Range* range;
+            uint64_t index;
+
+            public:
+                iterator(const Range* range, uint64_t index) : range(range), index(index) {};
+                double operator*() const { return (*range)[index]; };
+                iterator& operator++() { index++; return *this; };
+                bool operator!=(const iterator& other) const { return index != other.index; };
+        };
+
+        // nothing for a step of zero, or bounds or a step that are not finite
+        static std::optional<Range> make(double start, double step, double stop);
+
+        uint64_t size() const { return count; };
+        bool empty() const { return count == 0; };
+        // the i-th number, for i below size()
+        double operator[](uint64_t i) const { return first + step * (double)i; };
+        bool contains(double value) const;
+
+        iterator begin() const { return iterator(this, 0); };
+        iterator end() const { return iterator(this, count); };
+};
+
+// the range of a generator whose start, step and stop are numeric literals,
+// as they are after folding
+std::optional<Range> constantRange(const Generator& generator);
+
+// a Set holding every number of the range, allocated in arena
+Set* materialise(const Range& range, Arena& arena, Span span);
+
+#endif
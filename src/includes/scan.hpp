@@ -0,0 +1,68 @@
+#pragma once
+
+#ifndef SCAN_HPP
+#define SCAN_HPP
+
+// Kernels that find where a run of characters ends, used by the lexer to skip
+// over identifiers, numbers, whitespace and string bodies a block at a time.
+// Each returns the first position in [begin, end) that does not continue the
+// run, or end. An AVX2 or SSE2 implementation is picked once at startup on
+// x86, other targets use the scalar one.
+//
+// Most runs in real code are a few bytes long, so the first few bytes are
+// checked inline and only longer runs are handed to the vector kernels.
+
+namespace scan_detail
+{
+    constexpr int probe = 8;
+
+    const char* alpha(const char* begin, const char* end);
+    const char* digits(const char* begin, const char* end);
+    const char* blanks(const char* begin, const char* end);
+    const char* until(const char* begin, const char* end, char c);
+
+    inline bool is_alpha(char c) { return (unsigned char)((c | 0x20) - 'a') < 26; }
+    inline bool is_digit(char c) { return (unsigned char)(c - '0') < 10; }
+    inline bool is_blank(char c) { return c == ' ' || c == '\t'; }
+}
+
+inline const char* scan_alpha(const char* begin, const char* end)
+{
+    for (int i = 0; i < scan_detail::probe; i++, begin++)
+    {
+        if (begin == end || !scan_detail::is_alpha(*begin)) return begin;
+    }
+    return scan_detail::alpha(begin, end);
+}
+
+inline const char* scan_digits(const char* begin, const char* end)
+{
+    for (int i = 0; i < scan_detail::probe; i++, begin++)
+    {
+        if (begin == end || !scan_detail::is_digit(*begin)) return begin;
+    }
+    return scan_detail::digits(begin, end);
+}
+
+inline const char* scan_blanks(const char* begin, const char* end)
+{
+    for (int i = 0; i < scan_detail::probe; i++, begin++)
+    {
+        if (begin == end || !scan_detail::is_blank(*begin)) return begin;
+    }
+    return scan_detail::blanks(begin, end);
+}
+
+inline const char* scan_until(const char* begin, const char* end, char c)
+{
+    for (int i = 0; i < scan_detail::probe; i++, begin++)
+    {
+        if (begin == end || *begin == c) return begin;
+    }
+    return scan_detail::until(begin, end, c);
+}
+
+// "avx2", "sse2" or "scalar"
+const char* scan_implementation();
+
+#endif
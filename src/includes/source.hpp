@@ -0,0 +1,46 @@
+#pragma once
+
+#ifndef SOURCE_HPP
+#define SOURCE_HPP
+
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include "token.hpp"
+#include "LineColumn.hpp"
+
+// tokens hold 32 bit offsets, so longer text could not be addressed
+const size_t max_source_size = UINT32_MAX;
+
+// A view of the text being compiled, which tokens refer into, plus the
+// offset each line starts at so positions can be recovered from an offset.
+// The text itself is owned by the caller and must outlive the Source, and
+// is rejected when it is max_source_size bytes or more.
+class Source
+{
+    std::string_view content;
+    std::vector<uint32_t> lines;
+
+    public:
+        Source(std::string_view content);
+
+        std::string_view str() const { return content; };
+
+        std::string_view text(const Token& token) const;
+
+        void addLine(uint32_t offset);
+
+        // After an edit that replaced the whole lines starting in [from, to)
+        // and moved everything after them by delta bytes: content is the new
+        // text, starts the new lines' starts. Returns how many lines were
+        // added, negative when lines were removed.
+        int replace(std::string_view content, uint32_t from, uint32_t to, const std::vector<uint32_t>& starts, int64_t delta);
+
+        int lineCount() const { return lines.size(); };
+
+        LineColumn position(uint32_t offset) const;
+
+        LineColumn position(const Token& token) const { return position(token.offset); };
+};
+
+#endif
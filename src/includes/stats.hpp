@@ -0,0 +1,86 @@
+#pragma once
+
+#ifndef STATS_HPP
+#define STATS_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include "ast.hpp"
+#include "json.hpp"
+
+enum class Phase : uint8_t
+{
+    Read,
+    Cache,
+    Lex,
+    Parse,
+    Fold,
+    Output,
+};
+
+const size_t phase_count = 6;
+
+// What one phase cost, summed over every input it ran on. The count is
+// cache hits, tokens, nodes or nodes folded away, the bytes are those read,
+// allocated or written, depending on the phase.
+struct PhaseStats
+{
+    uint64_t runs = 0;
+    double seconds = 0;
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+    // the process's peak resident memory when the phase ended, in KB
+    long peakKb = 0;
+};
+
+// Where the time and memory of a compile went, phase by phase. Every input
+// gets its own Stats, so phases can run on any thread, then they are added up.
+class Stats
+{
+    public:
+        PhaseStats phases[phase_count];
+
+        PhaseStats& operator[](Phase phase) { return phases[(size_t)phase]; };
+
+        void add(const Stats& other);
+
+        void record(Phase phase, double seconds, uint64_t count, uint64_t bytes);
+
+        // a table for people, and the same as JSON, with the wall time of the whole run
+        void print(std::ostream& out, double wall) const;
+        void toJSON(JsonWriter& out, double wall) const;
+};
+
+// Times one phase into stats. Without stats it reads no clock at all, so
+// instrumented code costs nothing unless asked for its numbers.
+class PhaseTimer
+{
+    Stats* stats;
+    Phase phase;
+    std::chrono::steady_clock::time_point start;
+
+    public:
+        PhaseTimer(Stats* stats, Phase phase) : stats(stats), phase(phase)
+        {
+            if (stats != nullptr)
+            {
+                start = std::chrono::steady_clock::now();
+            }
+        };
+
+        // ends the phase; a phase that throws is never recorded
+        void done(uint64_t count = 0, uint64_t bytes = 0)
+        {
+            if (stats != nullptr)
+            {
+                std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                stats->record(phase, elapsed.count(), count, bytes);
+            }
+        };
+};
+
+// every node below and including root
+uint64_t countNodes(Node& root);
+
+#endif
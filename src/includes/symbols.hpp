@@ -0,0 +1,54 @@
+#pragma once
+
+#ifndef SYMBOLS_HPP
+#define SYMBOLS_HPP
+
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <vector>
+#include "arena.hpp"
+
+// An interned name: two symbols of the same table name the same thing
+// exactly when their ids are equal.
+struct Symbol
+{
+    uint32_t id;
+
+    bool operator==(Symbol other) const { return id == other.id; };
+    bool operator!=(Symbol other) const { return id != other.id; };
+};
+
+// the empty name, which every table starts with
+const Symbol empty_symbol = {0};
+
+// Every distinct name of one compilation, identifiers, type names and
+// operators alike, each stored once and numbered in the order it was first
+// seen. Interning is safe from several threads at once; looking names up is
+// not while anyone is still interning.
+class SymbolTable
+{
+    Arena arena;
+    std::vector<std::string_view> names;
+    // open addressing: a slot holds a name's id + 1, or 0 when free, and the
+    // table is kept at most half full; the hashes let it grow without
+    // hashing every name again
+    std::vector<uint32_t> slots;
+    std::vector<uint32_t> hashes;
+    std::mutex lock;
+
+    void insert(uint32_t id);
+
+    public:
+        SymbolTable();
+        SymbolTable(const SymbolTable&) = delete;
+        SymbolTable& operator=(const SymbolTable&) = delete;
+
+        Symbol intern(std::string_view name);
+
+        std::string_view name(Symbol symbol) const { return names[symbol.id]; };
+
+        size_t size() const { return names.size(); };
+};
+
+#endif
@@ -3,10 +3,9 @@
 #ifndef TOKEN_HPP
 #define TOKEN_HPP
 
-#include <string>
-#include "LineColumn.hpp"
+#include <cstdint>
 
-enum class TokenType
+enum class TokenType : uint8_t
 {
     // core
 
@@ -78,10 +77,13 @@ enum class TokenType
     ELIPSIS
 };
 
+// A token refers to its text in the Source it was lexed from, positions are
+// recovered through the Source's line table. INDENT, DEDENT, EoL and EoF have
+// no text and a length of zero.
 struct Token
 {
-    std::string value;
-    LineColumn pointer;
+    uint32_t offset;
+    uint32_t length;
     TokenType type;
 };
 
@@ -0,0 +1,90 @@
+#pragma once
+
+#ifndef TOKEN_STREAM_HPP
+#define TOKEN_STREAM_HPP
+
+#include <cstdint>
+#include <vector>
+#include "lexer.hpp"
+#include "token.hpp"
+
+// The tokens a parser reads, kept in a ring buffer that runs from the current
+// token to the furthest one looked at. They are pulled as the parser advances,
+// either from a lexer, which then lexes a few lines at a time so lexing and
+// parsing proceed together, or from tokens lexed beforehand. The ring only
+// grows for lookahead past a bracket's close, so it stays the size of the
+// longest bracketed expression rather than the input. Past the end every
+// token read is the input's EoF.
+class TokenStream
+{
+    // for every bracket token in the window, its matching close and, for `[`,
+    // the FOR or ELIPSIS directly inside it that decides which iterable it
+    // opens (ID when there is none), filled in as the tokens are pulled
+    struct Bracket
+    {
+        size_t close;
+        TokenType form;
+    };
+    struct Open
+    {
+        size_t index;
+        TokenType type;
+    };
+
+    std::vector<Token> ring;
+    std::vector<Bracket> brackets;
+    size_t mask;
+    // absolute indices of the current token and of the one after the window
+    size_t head;
+    size_t tail;
+    // brackets pulled but not yet closed, innermost last
+    std::vector<Open> open;
+
+    std::vector<Token> tokens;
+    size_t next;
+    Lexer* lexer;
+    bool exhausted;
+    Token last;
+
+    void pull();
+
+    void push(const Token& token);
+
+    void grow();
+
+    // pulls until the bracket ahead is closed or the input ends
+    const Bracket& bracket(size_t ahead);
+
+    public:
+        static constexpr size_t unmatched = SIZE_MAX;
+
+        TokenStream(std::vector<Token> tokens);
+        TokenStream(Lexer& lexer);
+
+        // the tokens given up front, empty when they come from a lexer
+        const std::vector<Token>& lexed() const { return tokens; };
+
+        const Token& peek(size_t ahead = 0)
+        {
+            if (head + ahead >= tail)
+            {
+                fill(ahead + 1);
+            }
+            return ring[(head + ahead) & mask];
+        };
+
+        void advance()
+        {
+            head++;
+        };
+
+        void fill(size_t count);
+
+        // how far ahead the close of the bracket ahead is, or unmatched
+        size_t closing(size_t ahead);
+
+        // FOR, ELIPSIS or ID, for a `[` ahead
+        TokenType form(size_t ahead) { return bracket(ahead).form; };
+};
+
+#endif
@@ -0,0 +1,236 @@
+#pragma once
+
+#ifndef VISITOR_HPP
+#define VISITOR_HPP
+
+#include <stdexcept>
+#include "ast.hpp"
+
+// Calls f on each of node's child pointers in source order, by reference so
+// that a pass may replace a child with another node of a class the slot can
+// hold. f is usually a generic lambda, or takes a Node* for just reading.
+// Switches on the node's kind, so the calls can be inlined.
+template <typename F>
+void eachChild(Node* node, F&& f)
+{
+    switch (node->kind)
+    {
+        case NodeKind::Program:
+            for (Statement*& statement : static_cast<Program*>(node)->program)
+            {
+                f(statement);
+            }
+            break;
+        case NodeKind::StatementBlock:
+            for (Statement*& statement : static_cast<StatementBlock*>(node)->statements)
+            {
+                f(statement);
+            }
+            break;
+        case NodeKind::FunctionPrototype:
+            for (Parameter*& param : static_cast<FunctionPrototype*>(node)->params)
+            {
+                f(param);
+            }
+            break;
+        case NodeKind::FunctionDefenition:
+        {
+            FunctionDefenition* definition = static_cast<FunctionDefenition*>(node);
+            f(definition->prototype);
+            f(definition->body);
+            break;
+        }
+        case NodeKind::ReturnStatement:
+            f(static_cast<ReturnStatement*>(node)->statement);
+            break;
+        case NodeKind::ForLoop:
+        {
+            ForLoop* loop = static_cast<ForLoop*>(node);
+            for (Identifier*& id : loop->ids)
+            {
+                f(id);
+            }
+            f(loop->iterable);
+            f(loop->body);
+            break;
+        }
+        case NodeKind::WhileLoop:
+        {
+            WhileLoop* loop = static_cast<WhileLoop*>(node);
+            f(loop->condition);
+            f(loop->body);
+            break;
+        }
+        case NodeKind::Assignment:
+            f(static_cast<Assignment*>(node)->rhs);
+            break;
+        case NodeKind::IfStatement:
+        {
+            IfStatement* statement = static_cast<IfStatement*>(node);
+            f(statement->conditional);
+            f(statement->ifBlock);
+            f(statement->elseBlock);
+            break;
+        }
+        case NodeKind::IterableLiteral:
+            for (Expression*& value : static_cast<IterableLiteral*>(node)->value)
+            {
+                f(value);
+            }
+            break;
+        case NodeKind::Subscription:
+        {
+            Subscription* subscription = static_cast<Subscription*>(node);
+            f(subscription->id);
+            f(subscription->index);
+            break;
+        }
+        case NodeKind::AttributeReference:
+        {
+            AttributeReference* reference = static_cast<AttributeReference*>(node);
+            f(reference->object);
+            f(reference->attribute);
+            break;
+        }
+        case NodeKind::Slice:
+        {
+            Slice* slice = static_cast<Slice*>(node);
+            f(slice->id);
+            f(slice->start);
+            f(slice->stop);
+            break;
+        }
+        case NodeKind::Generator:
+        {
+            Generator* generator = static_cast<Generator*>(node);
+            f(generator->start);
+            f(generator->step);
+            f(generator->stop);
+            break;
+        }
+        case NodeKind::BinaryExpression:
+        {
+            BinaryExpression* expression = static_cast<BinaryExpression*>(node);
+            f(expression->lhs);
+            f(expression->rhs);
+            break;
+        }
+        case NodeKind::ListComprehension:
+        {
+            ListComprehension* comprehension = static_cast<ListComprehension*>(node);
+            f(comprehension->body);
+            for (Identifier*& id : comprehension->ids)
+            {
+                f(id);
+            }
+            f(comprehension->iterable);
+            f(comprehension->filter);
+            break;
+        }
+        case NodeKind::FunctionCall:
+            for (Expression*& arg : static_cast<FunctionCall*>(node)->args)
+            {
+                f(arg);
+            }
+            break;
+        case NodeKind::Parameter:
+        case NodeKind::Identifier:
+        case NodeKind::NumericLiteral:
+        case NodeKind::BooleanLiteral:
+        case NodeKind::StringLiteral:
+        case NodeKind::List:
+        case NodeKind::Set:
+            break;
+    }
+}
+
+// The base of a pass over the AST, dispatched on the node's kind rather than
+// through a virtual method per pass. A pass derives from Visitor<Pass, Result>
+// and defines visit methods, visitIdentifier and so on, for the classes it
+// handles; visit(node) calls the pass's method for the node's class directly.
+// A method the pass leaves out falls back to the one for the class's base,
+// visitIterable, visitValue, visitExpression, visitStatement, then visitNode,
+// which visits the children and returns Result's default.
+template <typename Pass, typename Result = void>
+class Visitor
+{
+    Pass& pass() { return static_cast<Pass&>(*this); };
+
+    public:
+        Result visit(Node* node)
+        {
+            switch (node->kind)
+            {
+                case NodeKind::Program: return pass().visitProgram(static_cast<Program*>(node));
+                case NodeKind::StatementBlock: return pass().visitStatementBlock(static_cast<StatementBlock*>(node));
+                case NodeKind::Parameter: return pass().visitParameter(static_cast<Parameter*>(node));
+                case NodeKind::FunctionPrototype: return pass().visitFunctionPrototype(static_cast<FunctionPrototype*>(node));
+                case NodeKind::FunctionDefenition: return pass().visitFunctionDefenition(static_cast<FunctionDefenition*>(node));
+                case NodeKind::ReturnStatement: return pass().visitReturnStatement(static_cast<ReturnStatement*>(node));
+                case NodeKind::ForLoop: return pass().visitForLoop(static_cast<ForLoop*>(node));
+                case NodeKind::WhileLoop: return pass().visitWhileLoop(static_cast<WhileLoop*>(node));
+                case NodeKind::Assignment: return pass().visitAssignment(static_cast<Assignment*>(node));
+                case NodeKind::IfStatement: return pass().visitIfStatement(static_cast<IfStatement*>(node));
+                case NodeKind::Identifier: return pass().visitIdentifier(static_cast<Identifier*>(node));
+                case NodeKind::NumericLiteral: return pass().visitNumericLiteral(static_cast<NumericLiteral*>(node));
+                case NodeKind::BooleanLiteral: return pass().visitBooleanLiteral(static_cast<BooleanLiteral*>(node));
+                case NodeKind::StringLiteral: return pass().visitStringLiteral(static_cast<StringLiteral*>(node));
+                case NodeKind::IterableLiteral: return pass().visitIterableLiteral(static_cast<IterableLiteral*>(node));
+                case NodeKind::Subscription: return pass().visitSubscription(static_cast<Subscription*>(node));
+                case NodeKind::AttributeReference: return pass().visitAttributeReference(static_cast<AttributeReference*>(node));
+                case NodeKind::Slice: return pass().visitSlice(static_cast<Slice*>(node));
+                case NodeKind::List: return pass().visitList(static_cast<List*>(node));
+                case NodeKind::Set: return pass().visitSet(static_cast<Set*>(node));
+                case NodeKind::Generator: return pass().visitGenerator(static_cast<Generator*>(node));
+                case NodeKind::BinaryExpression: return pass().visitBinaryExpression(static_cast<BinaryExpression*>(node));
+                case NodeKind::ListComprehension: return pass().visitListComprehension(static_cast<ListComprehension*>(node));
+                case NodeKind::FunctionCall: return pass().visitFunctionCall(static_cast<FunctionCall*>(node));
+            }
+            throw std::runtime_error("Unknown node kind " + std::to_string((int)node->kind));
+        };
+
+        // visits each child in order, dropping what the visits return
+        void visitChildren(Node* node)
+        {
+            eachChild(node, [&](Node* child) { pass().visit(child); });
+        };
+
+        Result visitNode(Node* node)
+        {
+            pass().visitChildren(node);
+            return Result();
+        };
+
+        // the abstract classes
+        Result visitStatement(Statement* node) { return pass().visitNode(node); };
+        Result visitExpression(Expression* node) { return pass().visitStatement(node); };
+        Result visitValue(Value* node) { return pass().visitExpression(node); };
+        Result visitIterable(Iterable* node) { return pass().visitValue(node); };
+
+        Result visitProgram(Program* node) { return pass().visitNode(node); };
+        Result visitStatementBlock(StatementBlock* node) { return pass().visitStatement(node); };
+        Result visitParameter(Parameter* node) { return pass().visitNode(node); };
+        Result visitFunctionPrototype(FunctionPrototype* node) { return pass().visitStatement(node); };
+        Result visitFunctionDefenition(FunctionDefenition* node) { return pass().visitStatement(node); };
+        Result visitReturnStatement(ReturnStatement* node) { return pass().visitStatement(node); };
+        Result visitForLoop(ForLoop* node) { return pass().visitStatement(node); };
+        Result visitWhileLoop(WhileLoop* node) { return pass().visitStatement(node); };
+        Result visitAssignment(Assignment* node) { return pass().visitStatement(node); };
+        Result visitIfStatement(IfStatement* node) { return pass().visitStatement(node); };
+        Result visitIdentifier(Identifier* node) { return pass().visitValue(node); };
+        Result visitNumericLiteral(NumericLiteral* node) { return pass().visitValue(node); };
+        Result visitBooleanLiteral(BooleanLiteral* node) { return pass().visitValue(node); };
+        Result visitStringLiteral(StringLiteral* node) { return pass().visitIterable(node); };
+        Result visitIterableLiteral(IterableLiteral* node) { return pass().visitIterable(node); };
+        Result visitSubscription(Subscription* node) { return pass().visitValue(node); };
+        Result visitAttributeReference(AttributeReference* node) { return pass().visitValue(node); };
+        Result visitSlice(Slice* node) { return pass().visitIterable(node); };
+        Result visitList(List* node) { return pass().visitIterable(node); };
+        Result visitSet(Set* node) { return pass().visitIterable(node); };
+        Result visitGenerator(Generator* node) { return pass().visitIterable(node); };
+        Result visitBinaryExpression(BinaryExpression* node) { return pass().visitExpression(node); };
+        Result visitListComprehension(ListComprehension* node) { return pass().visitIterable(node); };
+        Result visitFunctionCall(FunctionCall* node) { return pass().visitExpression(node); };
+};
+
+#endif
@@ -1,18 +1,95 @@
 #include "includes/io.hpp"
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
-std::vector<std::string> split(std::string s, std::string delimiter) {
-    size_t pos_start = 0, pos_end, delim_len = delimiter.length();
-    std::string token;
-    std::vector<std::string> res;
+SourceFile SourceFile::open(const std::string& path)
+{
+    SourceFile file;
+    int fd = path == "-" ? STDIN_FILENO : ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error("Could not open " + path + ": " + std::strerror(errno));
+    }
 
-    while ((pos_end = s.find (delimiter, pos_start)) != std::string::npos) {
-        token = s.substr (pos_start, pos_end - pos_start);
-        pos_start = pos_end + delim_len;
-        res.push_back (token);
+    struct stat info;
+    if (fstat(fd, &info) != 0)
+    {
+        std::string error = std::strerror(errno);
+        if (fd != STDIN_FILENO) close(fd);
+        throw std::runtime_error("Could not stat " + path + ": " + error);
+    }
+    if (S_ISREG(info.st_mode) && info.st_size > 0)
+    {
+        void* mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED)
+        {
+            madvise(mapping, info.st_size, MADV_SEQUENTIAL);
+            file.data = static_cast<const char*>(mapping);
+            file.size = info.st_size;
+            file.mapped = true;
+        }
     }
 
-    res.push_back (s.substr (pos_start));
-    return res;
+    if (!file.mapped)
+    {
+        // one buffered read, growing the buffer as needed
+        size_t used = 0;
+        file.buffer.resize(S_ISREG(info.st_mode) && info.st_size > 0 ? info.st_size : 64 * 1024);
+        while (true)
+        {
+            if (used == file.buffer.size())
+            {
+                file.buffer.resize(file.buffer.size() * 2);
+            }
+            ssize_t n = read(fd, &file.buffer[used], file.buffer.size() - used);
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (n < 0)
+            {
+                std::string error = std::strerror(errno);
+                if (fd != STDIN_FILENO) close(fd);
+                throw std::runtime_error("Could not read " + path + ": " + error);
+            }
+            if (n == 0)
+            {
+                break;
+            }
+            used += n;
+        }
+        file.buffer.resize(used);
+        file.data = file.buffer.data();
+        file.size = used;
+    }
+
+    if (fd != STDIN_FILENO)
+    {
+        close(fd);
+    }
+    return file;
 }
 
+SourceFile::SourceFile(SourceFile&& other) : data(other.data), size(other.size), mapped(other.mapped), buffer(std::move(other.buffer))
+{
+    if (!this->mapped)
+    {
+        this->data = this->buffer.data();
+    }
+    other.data = nullptr;
+    other.size = 0;
+    other.mapped = false;
+}
 
+SourceFile::~SourceFile()
+{
+    if (this->mapped)
+    {
+        munmap(const_cast<char*>(this->data), this->size);
+    }
+}
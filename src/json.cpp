@@ -1,296 +1,713 @@
 #include "includes/ast.hpp"
-#include <iostream>
-#include <map>
+#include "includes/json.hpp"
+#include "includes/flat_ast.hpp"
+#include <charconv>
+#include <cmath>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <unistd.h>
 
-std::string newJsonNode(int lvl, std::string name, std::map<std::string, std::unique_ptr<Node>> children) 
+// writer
+
+// written out once this much is buffered
+const size_t json_flush_size = 64 * 1024;
+
+// comma and line break owed before a key or a value, none after a key
+void JsonWriter::separate()
 {
+    if (this->fd >= 0 && this->buffer.size() >= json_flush_size)
+    {
+        this->flush();
+    }
+    if (this->afterKey)
+    {
+        this->afterKey = false;
+        return;
+    }
+    if (this->empty.empty())
+    {
+        return;
+    }
+    if (!this->empty.back())
+    {
+        this->buffer += ',';
+    }
+    this->empty.back() = false;
+    this->newline();
+}
 
-    std::string tab(lvl,'\t');
-    std::string out = tab +"{\n";
-    out += tab + "\"" + name + "\": {\n";
-    for (auto const& [key, value] : children) {
-        out += tab + "\t\"" + key + "\": " + value->toJSON(lvl+1) + ",\n";
+void JsonWriter::newline()
+{
+    if (this->pretty)
+    {
+        this->buffer += '\n';
+        this->buffer.append(this->empty.size(), '\t');
+    }
+}
+
+void JsonWriter::quoted(std::string_view text)
+{
+    const char* hex = "0123456789abcdef";
+    this->buffer += '"';
+    size_t run = 0;
+    for (size_t i = 0; i < text.size(); i++)
+    {
+        unsigned char c = text[i];
+        if (c >= 0x20 && c != '"' && c != '\\')
+        {
+            continue;
+        }
+        this->buffer.append(text.substr(run, i - run));
+        run = i + 1;
+        switch (c)
+        {
+            case '"': this->buffer += "\\\""; break;
+            case '\\': this->buffer += "\\\\"; break;
+            case '\n': this->buffer += "\\n"; break;
+            case '\t': this->buffer += "\\t"; break;
+            case '\r': this->buffer += "\\r"; break;
+            default:
+                this->buffer += "\\u00";
+                this->buffer += hex[c >> 4];
+                this->buffer += hex[c & 15];
+        }
     }
-    out += tab + "}\n";
-    return out;
+    this->buffer.append(text.substr(run));
+    this->buffer += '"';
 }
 
-std::string Program::toJSON(int lvl)
+void JsonWriter::beginObject()
 {
+    this->separate();
+    this->buffer += '{';
+    this->empty.push_back(true);
+}
 
-    std::string out = "{\n";
-    std::string tab(lvl,'\t');
-    out += "\t\"program\" : [";
-    for (auto& s : program)
+void JsonWriter::endObject()
+{
+    bool was_empty = this->empty.back();
+    this->empty.pop_back();
+    if (!was_empty)
     {
-        out += "\n" + s->toJSON((lvl+2)) + ",";
+        this->newline();
+    }
+    this->buffer += '}';
+    if (this->empty.empty() && this->pretty)
+    {
+        this->buffer += '\n';
+    }
+}
+
+void JsonWriter::beginArray()
+{
+    this->separate();
+    this->buffer += '[';
+    this->empty.push_back(true);
+}
+
+void JsonWriter::endArray()
+{
+    bool was_empty = this->empty.back();
+    this->empty.pop_back();
+    if (!was_empty)
+    {
+        this->newline();
+    }
+    this->buffer += ']';
+    if (this->empty.empty() && this->pretty)
+    {
+        this->buffer += '\n';
     }
-    out += "\n" + tab + "]";
-    out += "\n}";
-    return out;
 }
 
-std::string Identifier::toJSON(int lvl)
+void JsonWriter::key(std::string_view name)
 {
-    std::string out = "";
-    std::string tab(lvl, '\t');
-    out = out + "\"identifier\" : " + "\"" + this->value + "\"";
-    return out;
+    this->separate();
+    this->quoted(name);
+    this->buffer += this->pretty ? ": " : ":";
+    this->afterKey = true;
 }
 
-std::string Parameter::toJSON(int lvl)
+void JsonWriter::string(std::string_view value)
 {
-    std::string out = "{";
-    std::string tab(lvl, '\t');
-    out += "\n" + tab + "\"parameter\" : {";
-    out += "\n\t" + tab + "\"id\" : \"" + this->id + "\"";
-    out += "\n\t" + tab + "\"type\" : \"" + this->type + "\"";
-    out += "\n\t" + tab + "}";
-    return out;
+    this->separate();
+    this->quoted(value);
 }
 
-std::string StatementBlock::toJSON(int lvl)
+void JsonWriter::number(double value)
 {
-    std::string out = "{ ";
-    for (auto& s : statements)
+    this->separate();
+    if (!std::isfinite(value))
     {
-        std::string tab(lvl, '\t');
-        out = out + "\n" + tab + "\"StatementBlock\" : {" + s->toJSON((lvl+1)) + "\n" + tab + "}";
+        this->buffer += "null"; // JSON has no infinities or NaN
+        return;
     }
-    return out;
+    char digits[32];
+    auto [end, error] = std::to_chars(digits, digits + sizeof(digits), value);
+    this->buffer.append(digits, end);
 }
 
-std::string FunctionPrototype::toJSON(int lvl)
+void JsonWriter::boolean(bool value)
 {
-    std::string out = "{";
-    std::string tab(lvl, '\t');
-    out += "\n" + tab + "\"FunctionPrototype\" : {";
-    out += "\n\t" + tab +"\"name \" :" + name + ",";
-    out += "\n\t" + tab +"\"params\": ";
-    for (auto& p : params)
+    this->separate();
+    this->buffer += value ? "true" : "false";
+}
+
+void JsonWriter::flush()
+{
+    if (this->fd < 0)
+    {
+        return;
+    }
+    size_t written = 0;
+    while (written < this->buffer.size())
     {
-        out += p->toJSON(lvl+1);
+        ssize_t n = ::write(this->fd, this->buffer.data() + written, this->buffer.size() - written);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n < 0)
+        {
+            throw std::runtime_error(std::string("Could not write output: ") + std::strerror(errno));
+        }
+        written += n;
     }
-    out += "\n\t" + tab + "],";
-    out += "\n\t" + tab +"\"return_type\" :" + return_type + ",";
-    out += "\n" + tab + "}";
-    return out;
+    this->flushed += this->buffer.size();
+    this->buffer.clear();
 }
 
-std::string FunctionDefenition::toJSON(int lvl)
+// nodes
+
+// opens {"name": {, closed again by endNode
+static void beginNode(JsonWriter& out, std::string_view name)
 {
-    std::string tab(lvl, '\t');
-    std::string out = tab + "{";
+    out.beginObject();
+    out.key(name);
+    out.beginObject();
+}
 
-    out += "\n\t" + tab + "\"FunctionDefenition\" : {";
-    out += "\n\t\t" + tab + "\"proto\" :" + prototype->toJSON(lvl+2) + ",";
-    out += "\n\t\t" + tab +"\"body\" :" + body->toJSON(lvl+2) + ",";
-    out += "\n\t" + tab + "}";
-    return out;
+static void endNode(JsonWriter& out)
+{
+    out.endObject();
+    out.endObject();
 }
 
-std::string ForLoop::toJSON(int lvl)
+void Program::toJSON(JsonWriter& out)
 {
-    std::string out = "{ ";
-    std::string tab(lvl, '\t');
-    out += "\n" + tab + "\"ForLoop\" : {";
-    out += "\n\t" + tab + "\"iterable: \"" + iterable->toJSON(lvl+1) + ",";
-    out += "\n\t" + tab + "\"body: \"" + body->toJSON(lvl+1) + ",";
-    for (auto& i : ids)
+    out.useSymbols(this->table.get());
+    out.beginObject();
+    out.key("program");
+    out.beginArray();
+    for (Statement* s : program)
     {
-        out += "\n\t" + tab + "\"id: \"" + i->toJSON(lvl+1) + ",";
+        s->toJSON(out);
     }
-    out += "\n" + tab + "}";
-    return out;
+    out.endArray();
+    out.endObject();
 }
 
-std::string WhileLoop::toJSON(int lvl)
+void Identifier::toJSON(JsonWriter& out)
 {
-    std::string out = "{ ";
-    std::string tab(lvl, '\t');
-    out += "\n" + tab + "\"WhileLoop\" : {";
-    out += "\n\t" + tab + "\"condition: \"" + condition->toJSON(lvl+1) + ",";
-    out += "\n\t" + tab + "\"body: \"" + body->toJSON(lvl+1) + ",";
-    out += "\n" + tab + "}";
-    return out;
+    out.beginObject();
+    out.key("identifier");
+    out.symbol(this->value);
+    out.endObject();
 }
 
-std::string Assignment::toJSON(int lvl)
+void Parameter::toJSON(JsonWriter& out)
 {
-    std::string out = "{ ";
-    std::string tab(lvl, '\t');
-    out += "\n" + tab + "\"Assignment\" : {";
-    out += "\n\t" + tab + "\"id\" : \"" + id + "\",";
-    out += "\n\t" + tab + "\"type\" : \"" + type + "\",";
-    out += "\n\t" + tab + "\"expr\" : " + rhs->toJSON(lvl+1) + ",";
-    out += "\n" + tab + "}";
-    return out;
+    beginNode(out, "parameter");
+    out.key("id");
+    out.symbol(this->id);
+    out.key("type");
+    out.symbol(this->type);
+    endNode(out);
 }
 
-std::string IfStatement::toJSON(int lvl)
+void StatementBlock::toJSON(JsonWriter& out)
 {
-    std::string out = "{ ";
-    std::string tab(lvl, '\t');
-    out += "\n" + tab + "\"IfStatement\" : {";
-    out += "\n\t" + tab + "\"condition\" : \"" + conditional->toJSON(lvl+1) + ",";
-    out += "\n\t" + tab + "\"ifblock\" : \"" + ifBlock->toJSON(lvl+1) + ",";
-    out += "\n\t" + tab + "\"elseblock\" : \"" + elseBlock->toJSON(lvl+1) + ",";
-    out += "\n" + tab + "}";
-    return out;
+    out.beginObject();
+    out.key("StatementBlock");
+    out.beginArray();
+    for (Statement* s : statements)
+    {
+        s->toJSON(out);
+    }
+    out.endArray();
+    out.endObject();
+}
+
+void FunctionPrototype::toJSON(JsonWriter& out)
+{
+    beginNode(out, "FunctionPrototype");
+    out.key("name");
+    out.symbol(name);
+    out.key("params");
+    out.beginArray();
+    for (Parameter* p : params)
+    {
+        p->toJSON(out);
+    }
+    out.endArray();
+    out.key("return_type");
+    out.symbol(return_type);
+    endNode(out);
+}
+
+void FunctionDefenition::toJSON(JsonWriter& out)
+{
+    beginNode(out, "FunctionDefenition");
+    out.key("proto");
+    prototype->toJSON(out);
+    out.key("body");
+    body->toJSON(out);
+    endNode(out);
+}
+
+void ForLoop::toJSON(JsonWriter& out)
+{
+    beginNode(out, "ForLoop");
+    out.key("ids");
+    out.beginArray();
+    for (Identifier* i : ids)
+    {
+        i->toJSON(out);
+    }
+    out.endArray();
+    out.key("iterable");
+    iterable->toJSON(out);
+    out.key("body");
+    body->toJSON(out);
+    endNode(out);
+}
+
+void WhileLoop::toJSON(JsonWriter& out)
+{
+    beginNode(out, "WhileLoop");
+    out.key("condition");
+    condition->toJSON(out);
+    out.key("body");
+    body->toJSON(out);
+    endNode(out);
+}
+
+void Assignment::toJSON(JsonWriter& out)
+{
+    beginNode(out, "Assignment");
+    out.key("id");
+    out.symbol(id);
+    out.key("type");
+    out.symbol(type);
+    out.key("expr");
+    rhs->toJSON(out);
+    endNode(out);
 }
 
-std::string NumericLiteral::toJSON(int lvl)
+void IfStatement::toJSON(JsonWriter& out)
 {
-    std::string out = "";
-    std::string tab(lvl, '\t');
-    out = out + "\"numeric_literal\" : " + "\"" + std::to_string(this->value) + "\"";
-    return out;
+    beginNode(out, "IfStatement");
+    out.key("condition");
+    conditional->toJSON(out);
+    out.key("ifblock");
+    ifBlock->toJSON(out);
+    out.key("elseblock");
+    elseBlock->toJSON(out);
+    endNode(out);
 }
 
-std::string BooleanLiteral::toJSON(int lvl)
+void NumericLiteral::toJSON(JsonWriter& out)
 {
-    std::string out = "";
-    std::string tab(lvl, '\t');
-    out = out + "\"boolean_literal\" : " + "\"" + (this->value ? "true" : "false") + "\"";
-    return out;
+    out.beginObject();
+    out.key("numeric_literal");
+    out.number(this->value);
+    out.endObject();
 }
 
-std::string StringLiteral::toJSON(int lvl)
+void BooleanLiteral::toJSON(JsonWriter& out)
 {
-    std::string out = "";
-    std::string tab(lvl, '\t');
-    out = out + "\"string_literal\" : " + "\"" + this->value + "\"";
-    return out;
+    out.beginObject();
+    out.key("boolean_literal");
+    out.boolean(this->value);
+    out.endObject();
 }
 
-std::string Subscription::toJSON(int lvl)
+void StringLiteral::toJSON(JsonWriter& out)
 {
-    std::string out = "";
-    std::string tab(lvl, '\t');
-    out = out + "\"subscription\" : {" ;
-    out += "\n" + tab + "\"id\" : " + id->toJSON(lvl+1);
-    out += "\n" + tab + "\"index\" : " + index->toJSON(lvl+1);
-    out += "\n" + tab + "}";
-    return out;
+    out.beginObject();
+    out.key("string_literal");
+    out.string(this->value);
+    out.endObject();
 }
 
-std::string AttributeReference::toJSON(int lvl)
+void Subscription::toJSON(JsonWriter& out)
 {
-    std::string out = "";
-    std::string tab(lvl, '\t');
-    out = out + "\"attribute_reference\" : {" ;
-    out += "\n" + tab + "\"id\" : " + object->toJSON(lvl+1);
-    out += "\n" + tab + "\"attr\" : " + attribute->toJSON(lvl+1);
-    out += "\n" + tab + "}";
-    return out;
+    beginNode(out, "subscription");
+    out.key("id");
+    id->toJSON(out);
+    out.key("index");
+    index->toJSON(out);
+    endNode(out);
 }
 
-std::string Slice::toJSON(int lvl)
+void AttributeReference::toJSON(JsonWriter& out)
 {
-    std::string out = "";
-    std::string tab(lvl, '\t');
-    out = out + "\"slice\" : {" ;
-    out += "\n" + tab + "\"id\" : " + id->toJSON(lvl+1);
-    out += "\n" + tab + "\"start\" : " + start->toJSON(lvl+1);
-    out += "\n" + tab + "\"stop\" : " + stop->toJSON(lvl+1);
-    out += "\n" + tab + "}";
-    return out;
+    beginNode(out, "attribute_reference");
+    out.key("id");
+    object->toJSON(out);
+    out.key("attr");
+    attribute->toJSON(out);
+    endNode(out);
 }
 
-std::string List::toJSON(int lvl)
+void Slice::toJSON(JsonWriter& out)
 {
-    std::string out = "";
-    std::string tab(lvl, '\t');
-    out = out + "\"list\" : [" ;
-    for (auto& i : elements)
+    beginNode(out, "slice");
+    out.key("id");
+    id->toJSON(out);
+    out.key("start");
+    start->toJSON(out);
+    out.key("stop");
+    stop->toJSON(out);
+    endNode(out);
+}
+
+void List::toJSON(JsonWriter& out)
+{
+    out.beginObject();
+    out.key("list");
+    out.beginArray();
+    for (std::string_view i : elements)
     {
-        out += i+ ",";
+        out.string(i);
     }
-    out += "\n" + tab + "]";
-    return out;
+    out.endArray();
+    out.endObject();
 }
 
-std::string Set::toJSON(int lvl)
+void Set::toJSON(JsonWriter& out)
 {
-    std::string out = "";
-    std::string tab(lvl, '\t');
-    out = out + "\"set\" : [" ;
-    for (auto& i : elements)
+    out.beginObject();
+    out.key("set");
+    out.beginArray();
+    for (double i : elements)
     {
-        out += std::to_string(i) + ",";
+        out.number(i);
     }
-    out += "\n" + tab + "]";
-    return out;
+    out.endArray();
+    out.endObject();
+}
+
+void Generator::toJSON(JsonWriter& out)
+{
+    beginNode(out, "generator");
+    out.key("start");
+    start->toJSON(out);
+    out.key("step");
+    step->toJSON(out);
+    out.key("stop");
+    stop->toJSON(out);
+    endNode(out);
 }
 
-std::string Generator::toJSON(int lvl)
+void BinaryExpression::toJSON(JsonWriter& out)
 {
-    std::string out = "";
-    std::string tab(lvl, '\t');
-    out = out + "\"generator\" : {" ;
-    out += "\n\t" + tab + "\"start\" : " + start->toJSON(lvl+1);
-    out += "\n\t" + tab + "\"step\" : " + step->toJSON(lvl+1);
-    out += "\n\t" + tab + "\"stop\" : " + stop->toJSON(lvl+1);
-    out += "\n\t" + tab + "}";
-    return out;
+    beginNode(out, "binary_expression");
+    out.key("op");
+    out.string(operator_text(op));
+    out.key("lhs");
+    lhs->toJSON(out);
+    out.key("rhs");
+    rhs->toJSON(out);
+    endNode(out);
 }
 
-std::string BinaryExpression::toJSON(int lvl)
+void ListComprehension::toJSON(JsonWriter& out)
 {
-    std::string out = "";
-    std::string tab(lvl, '\t');
-    out = out + "\"binary_expression\" : {" ;
-    out += "\n\t" + tab + "\"op\" : " + op;
-    out += "\n\t" + tab + "\"lhs\" : " + lhs->toJSON(lvl+1);
-    out += "\n\t" + tab + "\"rhs\" : " + rhs->toJSON(lvl+1);
-    out += "\n" + tab + "}";
-    return out;
+    beginNode(out, "list_comprehension");
+    out.key("body");
+    body->toJSON(out);
+    out.key("iterable");
+    iterable->toJSON(out);
+    out.key("ids");
+    out.beginArray();
+    for (Identifier* i : ids)
+    {
+        i->toJSON(out);
+    }
+    out.endArray();
+    out.key("filter");
+    filter->toJSON(out);
+    endNode(out);
 }
 
-std::string ListComprehension::toJSON(int lvl)
+void FunctionCall::toJSON(JsonWriter& out)
 {
-    std::string out = "";
-    std::string tab(lvl, '\t');
-    out = out + "\"list_comprehension\" : {" ;
-    out += "\n" + tab + "\"body\" : " + body->toJSON(lvl+1);
-    out += "\n" + tab + "\"iterable\" : " + iterable->toJSON(lvl+1);
-    for (auto& i : ids)
+    beginNode(out, "function_call");
+    out.key("id");
+    out.symbol(id);
+    out.key("args");
+    out.beginArray();
+    for (Expression* i : args)
     {
-        out += "\n" + tab + "\"id\" : " + i->toJSON(lvl+1);
+        i->toJSON(out);
     }
-    out += "\n" + tab + "\"filter\" : " + filter->toJSON(lvl+1);
-    out += "\n" + tab + "}";
-    return out;
+    out.endArray();
+    endNode(out);
+}
+
+void ReturnStatement::toJSON(JsonWriter& out)
+{
+    out.beginObject();
+    out.key("return_statement");
+    statement->toJSON(out);
+    out.endObject();
 }
 
-std::string FunctionCall::toJSON(int lvl)
+void IterableLiteral::toJSON(JsonWriter& out)
 {
-    std::string out = "{";
-    std::string tab(lvl, '\t');
-    out += "\n" + tab + "\"function_call\" : {" ;
-    out += "\n" + tab + "\"id\" : \"" + id + "\",";
-    for (auto& i : args)
+    out.beginObject();
+    out.key("iterable_literal");
+    out.beginArray();
+    for (Expression* e : value)
     {
-        out += "\n" + tab + "\"arg\" : " + i->toJSON(lvl+1);
+        e->toJSON(out);
     }
-    out += "\n" + tab + "}";
-    return out;
+    out.endArray();
+    out.endObject();
 }
 
-std::string ReturnStatement::toJSON(int lvl)
+// flat form, one case per node class above
+
+static void writeNode(const AstView& ast, uint32_t node, JsonWriter& out);
+
+static void writeNodes(const AstView& ast, const uint32_t* first, const uint32_t* last, JsonWriter& out)
 {
-    std::string out = "{ \"return_statement\" : " + statement->toJSON(lvl);
-    return out;
+    out.beginArray();
+    for (const uint32_t* i = first; i != last; i++)
+    {
+        writeNode(ast, *i, out);
+    }
+    out.endArray();
 }
 
-std::string IterableLiteral::toJSON(int lvl)
+static void writeNode(const AstView& ast, uint32_t node, JsonWriter& out)
 {
-    std::string tab(lvl, '\t');
-    std::string out = "{ \"iterable_literal\" : ";
-    for (auto& e : value)
+    FlatAst::View<uint32_t> children = ast.childrenOf(node);
+    FlatAst::Range payload = ast.payload(node);
+    switch (ast.kind(node))
     {
-        out += "\t" + e->toJSON(lvl+1);
+        case NodeKind::Program:
+            out.beginObject();
+            out.key("program");
+            writeNodes(ast, children.begin(), children.end(), out);
+            out.endObject();
+            break;
+        case NodeKind::StatementBlock:
+            out.beginObject();
+            out.key("StatementBlock");
+            writeNodes(ast, children.begin(), children.end(), out);
+            out.endObject();
+            break;
+        case NodeKind::Parameter:
+            beginNode(out, "parameter");
+            out.key("id");
+            out.string(ast.string(payload.first));
+            out.key("type");
+            out.string(ast.string(payload.first + 1));
+            endNode(out);
+            break;
+        case NodeKind::FunctionPrototype:
+            beginNode(out, "FunctionPrototype");
+            out.key("name");
+            out.string(ast.string(payload.first));
+            out.key("params");
+            writeNodes(ast, children.begin(), children.end(), out);
+            out.key("return_type");
+            out.string(ast.string(payload.first + 1));
+            endNode(out);
+            break;
+        case NodeKind::FunctionDefenition:
+            beginNode(out, "FunctionDefenition");
+            out.key("proto");
+            writeNode(ast, children[0], out);
+            out.key("body");
+            writeNode(ast, children[1], out);
+            endNode(out);
+            break;
+        case NodeKind::ReturnStatement:
+            out.beginObject();
+            out.key("return_statement");
+            writeNode(ast, children[0], out);
+            out.endObject();
+            break;
+        case NodeKind::ForLoop:
+            beginNode(out, "ForLoop");
+            out.key("ids");
+            writeNodes(ast, children.begin(), children.end() - 2, out);
+            out.key("iterable");
+            writeNode(ast, children[children.size() - 2], out);
+            out.key("body");
+            writeNode(ast, children[children.size() - 1], out);
+            endNode(out);
+            break;
+        case NodeKind::WhileLoop:
+            beginNode(out, "WhileLoop");
+            out.key("condition");
+            writeNode(ast, children[0], out);
+            out.key("body");
+            writeNode(ast, children[1], out);
+            endNode(out);
+            break;
+        case NodeKind::Assignment:
+            beginNode(out, "Assignment");
+            out.key("id");
+            out.string(ast.string(payload.first));
+            out.key("type");
+            out.string(ast.string(payload.first + 1));
+            out.key("expr");
+            writeNode(ast, children[0], out);
+            endNode(out);
+            break;
+        case NodeKind::IfStatement:
+            beginNode(out, "IfStatement");
+            out.key("condition");
+            writeNode(ast, children[0], out);
+            out.key("ifblock");
+            writeNode(ast, children[1], out);
+            out.key("elseblock");
+            writeNode(ast, children[2], out);
+            endNode(out);
+            break;
+        case NodeKind::Identifier:
+            out.beginObject();
+            out.key("identifier");
+            out.string(ast.string(payload.first));
+            out.endObject();
+            break;
+        case NodeKind::NumericLiteral:
+            out.beginObject();
+            out.key("numeric_literal");
+            out.number(ast.numbersOf(node)[0]);
+            out.endObject();
+            break;
+        case NodeKind::BooleanLiteral:
+            out.beginObject();
+            out.key("boolean_literal");
+            out.boolean(payload.first != 0);
+            out.endObject();
+            break;
+        case NodeKind::StringLiteral:
+            out.beginObject();
+            out.key("string_literal");
+            out.string(ast.string(payload.first));
+            out.endObject();
+            break;
+        case NodeKind::IterableLiteral:
+            out.beginObject();
+            out.key("iterable_literal");
+            writeNodes(ast, children.begin(), children.end(), out);
+            out.endObject();
+            break;
+        case NodeKind::Subscription:
+            beginNode(out, "subscription");
+            out.key("id");
+            writeNode(ast, children[0], out);
+            out.key("index");
+            writeNode(ast, children[1], out);
+            endNode(out);
+            break;
+        case NodeKind::AttributeReference:
+            beginNode(out, "attribute_reference");
+            out.key("id");
+            writeNode(ast, children[0], out);
+            out.key("attr");
+            writeNode(ast, children[1], out);
+            endNode(out);
+            break;
+        case NodeKind::Slice:
+            beginNode(out, "slice");
+            out.key("id");
+            writeNode(ast, children[0], out);
+            out.key("start");
+            writeNode(ast, children[1], out);
+            out.key("stop");
+            writeNode(ast, children[2], out);
+            endNode(out);
+            break;
+        case NodeKind::List:
+            out.beginObject();
+            out.key("list");
+            out.beginArray();
+            for (uint32_t i = 0; i < payload.count; i++)
+            {
+                out.string(ast.string(payload.first + i));
+            }
+            out.endArray();
+            out.endObject();
+            break;
+        case NodeKind::Set:
+        {
+            FlatAst::View<double> numbers = ast.numbersOf(node);
+            out.beginObject();
+            out.key("set");
+            out.beginArray();
+            for (uint32_t i = 1; i < numbers.size(); i++)
+            {
+                out.number(numbers[i]); // the first is the element type
+            }
+            out.endArray();
+            out.endObject();
+            break;
+        }
+        case NodeKind::Generator:
+            beginNode(out, "generator");
+            out.key("start");
+            writeNode(ast, children[0], out);
+            out.key("step");
+            writeNode(ast, children[1], out);
+            out.key("stop");
+            writeNode(ast, children[2], out);
+            endNode(out);
+            break;
+        case NodeKind::BinaryExpression:
+            beginNode(out, "binary_expression");
+            out.key("op");
+            out.string(ast.string(payload.first));
+            out.key("lhs");
+            writeNode(ast, children[0], out);
+            out.key("rhs");
+            writeNode(ast, children[1], out);
+            endNode(out);
+            break;
+        case NodeKind::ListComprehension:
+            beginNode(out, "list_comprehension");
+            out.key("body");
+            writeNode(ast, children[0], out);
+            out.key("iterable");
+            writeNode(ast, children[1], out);
+            out.key("ids");
+            writeNodes(ast, children.begin() + 3, children.end(), out);
+            out.key("filter");
+            writeNode(ast, children[2], out);
+            endNode(out);
+            break;
+        case NodeKind::FunctionCall:
+            beginNode(out, "function_call");
+            out.key("id");
+            out.string(ast.string(payload.first));
+            out.key("args");
+            writeNodes(ast, children.begin(), children.end(), out);
+            endNode(out);
+            break;
     }
+}
 
-    return out;
-}
\ No newline at end of file
+void writeJSON(const AstView& ast, JsonWriter& out)
+{
+    if (ast.size() > 0)
+    {
+        writeNode(ast, 0, out);
+    }
+}
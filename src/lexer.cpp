@@ -1,181 +1,365 @@
 #include "includes/lexer.hpp"
-#include <boost/regex.hpp>
 #include <string.h>
+#include <stdexcept>
 #include <iostream>
+#include <algorithm>
 
-Lexer::Lexer(std::string content)
+Lexer::Lexer(Source& source, int tabWidth) : source(source), content(source.str())
 {
-    this->content = content;
-    this->lineNumber = 0;
-    this->columnNumber = 0;
+    this->tabWidth = tabWidth;
+    this->indents = {0};
+    this->chunked = false;
+    this->streamed = 0;
+    this->ended = false;
+    this->streamedTokens = 0;
 }
 
 std::vector<Token> Lexer::init()
 {
-    std::vector<std::string> lines = split(this->content, "\n");
-    lines.erase(std::remove(lines.begin(), lines.end(), ""), lines.end());
-
-    // netsed level
-    int level = 0;
-    std::vector<Token> tmp_tokens;
-    for (std::string line : lines)
-    {
-        std::tie(tmp_tokens, level) = this->tokenize(line, level);
-        this->tokens.insert(this->tokens.end(), tmp_tokens.begin(), tmp_tokens.end());
-    }
-    this->tokens.push_back({"EoF",{tokens[-1].pointer.line, 0}, TokenType::EoF});
+    this->lexLines(0, this->content.size());
+    this->close(this->content.size());
+    this->tokens.push_back(this->make(TokenType::EoF, this->content.size(), this->content.size()));
     return this->tokens;
 }
 
-void Lexer::advance()
+// smallest chunk worth handing to another thread
+static const size_t minimum_chunk = 256 * 1024;
+
+std::vector<Token> Lexer::init(ThreadPool& pool)
 {
-    if (this->cursor < this->line.size())
+    size_t size = this->content.size();
+    size_t count = std::min<size_t>(size / minimum_chunk, 4 * (pool.workers() + 1));
+    if (count < 2)
     {
-        this->cursor += 1;
-        this->character = this->line[this->cursor];
-        this->columnNumber += 1;
+        return this->init();
     }
-    else
+
+    // chunks end just after a newline, so no line is split
+    std::vector<size_t> cuts;
+    for (size_t i = 1; i < count; i++)
     {
-        this->cursor += 1;
+        size_t end = this->content.find('\n', std::max(cuts.empty() ? 0 : cuts.back(), size * i / count));
+        if (end == std::string_view::npos || end + 1 == size)
+        {
+            break;
+        }
+        cuts.push_back(end + 1);
     }
+    return this->init(pool, cuts);
 }
 
-void Lexer::goBack()
+std::vector<Token> Lexer::init(ThreadPool& pool, const std::vector<size_t>& cuts)
 {
-    this->cursor -= 1;
-}
+    size_t size = this->content.size();
+    std::vector<size_t> bounds = {0};
+    for (size_t cut : cuts)
+    {
+        if (cut <= bounds.back() || cut >= size || this->content[cut - 1] != '\n')
+        {
+            throw std::runtime_error("Chunks must be cut just after a newline, in order, not at " + std::to_string(cut));
+        }
+        bounds.push_back(cut);
+    }
+    bounds.push_back(size);
 
-Token Lexer::collect_identifier()
-{
-    std::string value = "";
-    while (this->cursor <= this->line.size() && isalpha(this->character))
+    std::vector<std::unique_ptr<Lexer>> chunks(bounds.size() - 1);
     {
-        value += this->character;
-        this->advance();
+        TaskGroup group = TaskGroup(pool);
+        for (size_t i = 0; i < chunks.size(); i++)
+        {
+            group.run([&, i]
+            {
+                chunks[i] = std::make_unique<Lexer>(this->source, this->tabWidth);
+                chunks[i]->chunked = true;
+                chunks[i]->lexLines(bounds[i], bounds[i + 1]);
+            });
+        }
+        group.wait();
     }
 
-    if (this->keywords.count(value))
+    // replay every chunk's indentation through the one indent stack
+    size_t total = 0;
+    for (const std::unique_ptr<Lexer>& chunk : chunks)
     {
-        return {value, {this->lineNumber, this->columnNumber}, this->keywords[value]};
+        total += chunk->tokens.size() + chunk->marks.size();
     }
-    else
+    this->tokens.reserve(total + this->indents.size() + 1);
+    for (const std::unique_ptr<Lexer>& chunk : chunks)
     {
-        return {value, {this->lineNumber, this->columnNumber}, TokenType::ID};
+        this->replay(*chunk, this->source.lineCount());
+        for (uint32_t start : chunk->lineStarts)
+        {
+            this->source.addLine(start);
+        }
     }
+    this->close(size);
+    this->tokens.push_back(this->make(TokenType::EoF, size, size));
+    return this->tokens;
 }
 
-Token Lexer::collect_number()
+std::vector<Token> Lexer::relex(size_t start, size_t end, int linesBefore)
+{
+    Lexer chunk = Lexer(this->source, this->tabWidth);
+    chunk.chunked = true;
+    chunk.lexLines(start, end);
+    this->tokens.reserve(chunk.tokens.size() + chunk.marks.size());
+    this->replay(chunk, linesBefore);
+    this->close(end);
+    return this->tokens;
+}
+
+const std::vector<Token>& Lexer::next(size_t count)
 {
-    std::string value = "";
-    while (this->cursor <= this->line.size() && isdigit(this->character) or this->character == '.')
+    this->tokens.clear();
+    size_t size = this->content.size();
+    while (this->tokens.size() < count && this->streamed < size)
     {
-        char c = this->character;
-        char cs = value.back();
-        if (this->character=='.' && value.back()=='.') {
-            this->goBack();
-            break;
-        }
-        value += this->character;
-        this->advance();
+        size_t lineEnd = this->content.find('\n', this->streamed);
+        size_t end = lineEnd == std::string_view::npos ? size : lineEnd + 1;
+        this->lexLines(this->streamed, end);
+        this->streamed = end;
     }
-    if (value.back() == '.')
+    if (this->streamed == size && !this->ended)
     {
-        value.pop_back();
-    } // remove any trailing dots
-    return {value, {this->lineNumber, this->columnNumber}, TokenType::NUMBER};
+        this->close(size);
+        this->tokens.push_back(this->make(TokenType::EoF, size, size));
+        this->ended = true;
+    }
+    this->streamedTokens += this->tokens.size();
+    return this->tokens;
 }
 
-Token Lexer::collect_string(char close)
+// appends a chunk's tokens with its indentation resolved against our indent
+// stack, its lines numbered from after linesBefore
+void Lexer::replay(const Lexer& chunk, int linesBefore)
 {
-    std::string value = "";
-    while (this->cursor < this->line.size())
+    size_t copied = 0;
+    for (const IndentMark& mark : chunk.marks)
     {
-        this->advance();
-        if (this->character != close)
+        this->tokens.insert(this->tokens.end(), chunk.tokens.begin() + copied, chunk.tokens.begin() + mark.token);
+        copied = mark.token;
+        this->cursor = mark.offset;
+        this->resolve(mark.width, linesBefore + mark.line);
+    }
+    this->tokens.insert(this->tokens.end(), chunk.tokens.begin() + copied, chunk.tokens.end());
+}
+
+// walk the buffer one line at a time without copying it, empty lines are skipped
+void Lexer::lexLines(size_t start, size_t end)
+{
+    while (start < end)
+    {
+        size_t lineEnd = this->content.find('\n', start);
+        if (lineEnd == std::string_view::npos || lineEnd > end)
         {
-            value += this->character;
+            lineEnd = end;
+        }
+        if (this->chunked)
+        {
+            this->lineStarts.push_back(start);
         }
         else
         {
-            this->advance();
-            break;
+            this->source.addLine(start);
         }
+        if (lineEnd > start)
+        {
+            this->tokenize(start, lineEnd);
+        }
+        start = lineEnd + 1;
     }
-    return {value, {this->lineNumber, this->columnNumber}, TokenType::STRING};
 }
 
-std::string Lexer::characterAt(int index, int lookahead)
+// close any blocks still open where the input ends
+void Lexer::close(size_t end)
 {
-    return this->line.substr(index, index + lookahead);
+    while (this->indents.size() > 1)
+    {
+        this->indents.pop_back();
+        this->tokens.push_back(this->make(TokenType::DEDENT, end, end));
+    }
 }
 
-std::tuple<std::vector<Token>, int> Lexer::tokenize(std::string line, int level)
+Token Lexer::make(TokenType type, size_t start, size_t end)
 {
-    this->lineNumber++;
-    this->columnNumber = 0;
-
-    // replace spaces with tabs
-    boost::regex re("    ");
-    std::string s = boost::regex_replace(line, re, "\t");
-    this->line = s;
-    this->cursor = 0;
-    this->character = this->line[this->cursor];
-    this->level = level;
-    std::vector<Token> tokens = {};
+    return {(uint32_t)start, (uint32_t)(end - start), type};
+}
 
-    while (this->cursor < this->line.size())
+// moves the cursor past the leading whitespace and returns its width in columns
+int Lexer::measureIndent()
+{
+    int width = 0;
+    while (this->cursor < this->lineEnd)
     {
-        int diff = level - std::count(this->line.begin(), this->line.end(), '\t');
-        if (this->character == '#')
-        {
-            Token t = {"COMMENT", {this->lineNumber, this->columnNumber}, TokenType::COMMENT};
-
-            return {{t}, level};
-        }
-        else if (level < std::count(this->line.begin(), this->line.end(), '\t'))
-        {
-            tokens.push_back({"INDENT", {this->lineNumber, this->columnNumber}, TokenType::INDENT});
-            level += 1;
-            this->advance();
-        }
-        else if (level > std::count(this->line.begin(), this->line.end(), '\t'))
-        {
-            tokens.push_back({"DEDENT", {this->lineNumber, this->columnNumber}, TokenType::DEDENT});
-            level -= 1;
-            // this->advance();
-        }
-        else if (isalpha(this->character))
+        char c = this->content[this->cursor];
+        if (c == ' ')
         {
-            tokens.push_back(this->collect_identifier());
+            width += 1;
         }
-        else if (isdigit(this->character))
+        else if (c == '\t')
         {
-            tokens.push_back(this->collect_number());
+            width += this->tabWidth - width % this->tabWidth;
         }
-        else if (this->character == '"' || this->character == '\'')
+        else
         {
-            tokens.push_back(this->collect_string(this->character));
+            break;
         }
-        else if (this->double_operators.count(this->line.substr(this->cursor, 2)))
+        this->cursor++;
+    }
+    this->character = this->cursor < this->lineEnd ? this->content[this->cursor] : '\0';
+    return width;
+}
+
+void Lexer::indent(int width)
+{
+    if (this->chunked)
+    {
+        this->marks.push_back({this->tokens.size(), width, (uint32_t)this->cursor, (uint32_t)this->lineStarts.size()});
+        return;
+    }
+    this->resolve(width, this->source.lineCount());
+}
+
+void Lexer::resolve(int width, int line)
+{
+    if (width > this->indents.back())
+    {
+        this->indents.push_back(width);
+        this->tokens.push_back(this->make(TokenType::INDENT, this->cursor, this->cursor));
+        return;
+    }
+    while (width < this->indents.back())
+    {
+        this->indents.pop_back();
+        this->tokens.push_back(this->make(TokenType::DEDENT, this->cursor, this->cursor));
+    }
+    if (width != this->indents.back())
+    {
+        throw std::runtime_error("Inconsistent indentation on line " + std::to_string(line));
+    }
+}
+
+void Lexer::advance()
+{
+    this->cursor += 1;
+    this->character = this->cursor < this->lineEnd ? this->content[this->cursor] : '\0';
+}
+
+// moves the cursor to a position found by one of the scan kernels
+void Lexer::seek(const char* position)
+{
+    this->cursor = position - this->content.data();
+    this->character = this->cursor < this->lineEnd ? this->content[this->cursor] : '\0';
+}
+
+Token Lexer::collect_identifier()
+{
+    size_t start = this->cursor;
+    this->seek(scan_alpha(this->content.data() + start, this->content.data() + this->lineEnd));
+    std::string_view value(this->content.data() + start, this->cursor - start);
+    return this->make(keyword(value), start, this->cursor);
+}
+
+Token Lexer::collect_number()
+{
+    const char* line_end = this->content.data() + this->lineEnd;
+    size_t start = this->cursor;
+    const char* p = this->content.data() + start;
+    while (true)
+    {
+        p = scan_digits(p, line_end);
+        // a single dot continues the number, two dots start an ELIPSIS
+        if (p < line_end && *p == '.' && !(p + 1 < line_end && p[1] == '.'))
         {
-            std::string value = this->line.substr(this->cursor, 2);
-            tokens.push_back({value, {this->lineNumber, this->columnNumber}, this->double_operators[value]});
-            this->advance();
-            this->advance();
+            p++;
+            continue;
         }
-        else if (this->single_operators.count(this->character))
+        break;
+    }
+    this->seek(p);
+    size_t end = this->cursor;
+    if (this->content[end - 1] == '.')
+    {
+        end--;
+    } // remove any trailing dots
+    return this->make(TokenType::NUMBER, start, end);
+}
+
+// the token covers the string's contents, not its quotes
+Token Lexer::collect_string(char close)
+{
+    const char* line_end = this->content.data() + this->lineEnd;
+    size_t start = this->cursor + 1;
+    const char* closing = scan_until(this->content.data() + start, line_end, close);
+    this->seek(closing < line_end ? closing + 1 : line_end);
+    return this->make(TokenType::STRING, start, closing - this->content.data());
+}
+
+void Lexer::tokenize(size_t start, size_t end)
+{
+    this->lineStart = start;
+    this->lineEnd = end;
+    this->cursor = start;
+    int width = this->measureIndent();
+    if (this->cursor == this->lineEnd)
+    {
+        return; // whitespace only, does not affect indentation
+    }
+    if (this->character == '#')
+    {
+        // comment lines do not affect indentation either
+        this->tokens.push_back(this->make(TokenType::COMMENT, this->cursor, this->lineEnd));
+        return;
+    }
+    this->indent(width);
+    size_t first = this->tokens.size();
+
+    while (this->cursor < this->lineEnd)
+    {
+        switch (char_class(this->character))
         {
-            std::string s;
-            s += this->character;
-            tokens.push_back({s, {this->lineNumber, this->columnNumber}, this->single_operators[this->character]});
-            this->advance();
+            case CharClass::COMMENT:
+                // a comment replaces everything lexed on its line
+                this->tokens.resize(first);
+                this->tokens.push_back(this->make(TokenType::COMMENT, this->cursor, this->lineEnd));
+                return;
+            case CharClass::ALPHA:
+                this->tokens.push_back(this->collect_identifier());
+                break;
+            case CharClass::DIGIT:
+                this->tokens.push_back(this->collect_number());
+                break;
+            case CharClass::QUOTE:
+                this->tokens.push_back(this->collect_string(this->character));
+                break;
+            case CharClass::OPERATOR:
+            {
+                TokenType type = TokenType::ID;
+                if (this->cursor + 1 < this->lineEnd)
+                {
+                    type = double_operator(this->character, this->content[this->cursor + 1]);
+                }
+                if (type != TokenType::ID)
+                {
+                    this->tokens.push_back(this->make(type, this->cursor, this->cursor + 2));
+                    this->advance();
+                    this->advance();
+                    break;
+                }
+                type = single_operator(this->character);
+                if (type != TokenType::ID)
+                {
+                    this->tokens.push_back(this->make(type, this->cursor, this->cursor + 1));
+                }
+                this->advance();
+                break;
+            }
+            case CharClass::BLANK:
+                this->seek(scan_blanks(this->content.data() + this->cursor, this->content.data() + this->lineEnd));
+                break;
+            default:
+                this->advance();
         }
-        else
-        {
-            this->advance();
-        };
-    };
-    tokens.push_back({"EOL", {this->lineNumber, this->columnNumber}, TokenType::EoL});
-    return {tokens, level};
+    }
+    this->tokens.push_back(this->make(TokenType::EoL, this->lineEnd, this->lineEnd));
 };
@@ -1,26 +1,384 @@
+#include <algorithm>
+#include <charconv>
 #include <iostream>
-#include <fstream>
 #include <string>
-#include <sstream>
 #include <vector>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "includes/io.hpp"
+#include "includes/json.hpp"
 #include "includes/parser.hpp"
 #include "includes/lexer.hpp"
+#include "includes/flat_ast.hpp"
+#include "includes/ast_file.hpp"
+#include "includes/cache.hpp"
+#include "includes/fold.hpp"
+#include "includes/pool.hpp"
+#include "includes/stats.hpp"
 
+struct Options
+{
+    bool compact = false;
+    // write the parse to <path>.ast instead of printing it
+    bool emitAst = false;
+    // reuse parses of unchanged sources from this directory
+    std::string cacheDirectory;
+    uint64_t cacheLimit = 256;
+    bool cacheStats = false;
+    unsigned jobs = ThreadPool::defaultWorkers() + 1;
+    // split big inputs at top-level statements and parse the pieces in parallel
+    bool parallelParse = false;
+    // lex big inputs in chunks in parallel
+    bool parallelLex = false;
+    // fold constant expressions before output
+    bool fold = false;
+    // "table" or "json" to report where the time went, on stderr
+    std::string stats;
+};
 
-int main() {
+static bool ends_with(const std::string& text, const std::string& suffix)
+{
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
 
-    std::ifstream inFile;
-    inFile.open("src/examples/test.mu"); 
+// the whole of text as a number, false for anything else
+static bool parse_count(const std::string& text, uint64_t& value)
+{
+    const char* end = text.data() + text.size();
+    std::from_chars_result result = std::from_chars(text.data(), end, value);
+    return !text.empty() && result.ec == std::errc() && result.ptr == end;
+}
 
-    std::stringstream strStream;
-    strStream << inFile.rdbuf(); 
-    std::string content = strStream.str(); 
-    Lexer l = Lexer(content);
-    std::vector<Token> tokens = l.init();
-    // for (Token t : tokens) {
-    //     std::cout << t.value << std::endl;
-    // }
-    Parser parser = Parser(tokens);
-    std::cout <<  parser.parse()->toJSON(0);
-    return 0;
-}
\ No newline at end of file
+static void report(const ParseCache& cache)
+{
+    std::cerr << "cache: " << cache.hits() << " hits, " << cache.misses() << " misses, " << cache.evictions() << " evicted" << std::endl;
+}
+
+// directories stand for every .mu file below them, in name order
+static void collect(const std::string& path, std::vector<std::string>& files)
+{
+    struct stat info;
+    if (path == "-" || stat(path.c_str(), &info) != 0 || !S_ISDIR(info.st_mode))
+    {
+        files.push_back(path); // opening it reports anything wrong
+        return;
+    }
+    std::vector<std::string> entries;
+    if (DIR* dir = opendir(path.c_str()))
+    {
+        while (struct dirent* entry = readdir(dir))
+        {
+            std::string name = entry->d_name;
+            if (name != "." && name != "..")
+            {
+                entries.push_back(path + "/" + name);
+            }
+        }
+        closedir(dir);
+    }
+    std::sort(entries.begin(), entries.end());
+    for (const std::string& entry : entries)
+    {
+        if (stat(entry.c_str(), &info) == 0 && (S_ISDIR(info.st_mode) || ends_with(entry, ".mu")))
+        {
+            collect(entry, files);
+        }
+    }
+}
+
+// everything one input needs is created here, so inputs can be compiled on
+// any number of threads at once
+static void compile(const std::string& path, JsonWriter& out, const Options& options, ParseCache* cache, ThreadPool* pool, Stats* stats)
+{
+    if (ends_with(path, ".ast"))
+    {
+        // a previous parse, printed straight from the mapped file
+        PhaseTimer read = PhaseTimer(stats, Phase::Read);
+        AstFile file = AstFile::open(path);
+        read.done();
+        PhaseTimer output = PhaseTimer(stats, Phase::Output);
+        size_t before = out.size();
+        writeJSON(file.view(), out);
+        output.done(0, out.size() - before);
+        return;
+    }
+
+    // mapped files are only paged in as the lexer reaches them, so most of
+    // their reading is counted as lexing, or as parsing when that pulls the tokens
+    PhaseTimer read = PhaseTimer(stats, Phase::Read);
+    SourceFile file = SourceFile::open(path);
+    read.done(0, file.view().size());
+    if (cache != nullptr)
+    {
+        PhaseTimer lookup = PhaseTimer(stats, Phase::Cache);
+        std::optional<AstFile> hit = cache->find(file.view());
+        lookup.done(hit ? 1 : 0);
+        if (hit)
+        {
+            PhaseTimer output = PhaseTimer(stats, Phase::Output);
+            size_t before = out.size();
+            writeJSON(hit->view(), out);
+            output.done(0, out.size() - before);
+            return;
+        }
+    }
+
+    Source source = Source(file.view());
+    Lexer l = Lexer(source);
+    std::unique_ptr<Program> program;
+    if (pool != nullptr && (options.parallelLex || options.parallelParse))
+    {
+        PhaseTimer lex = PhaseTimer(stats, Phase::Lex);
+        std::vector<Token> tokens = options.parallelLex ? l.init(*pool) : l.init();
+        lex.done(tokens.size(), tokens.size() * sizeof(Token));
+        PhaseTimer parse = PhaseTimer(stats, Phase::Parse);
+        Parser parser = Parser(std::move(tokens), source);
+        program = options.parallelParse ? parser.parse(*pool) : parser.parse();
+        parse.done(0, program->bytesUsed());
+    }
+    else
+    {
+        // the parser pulls its tokens as it goes, so parsing includes lexing
+        PhaseTimer parse = PhaseTimer(stats, Phase::Parse);
+        Parser parser = Parser(l, source);
+        program = parser.parse();
+        parse.done(0, program->bytesUsed());
+        if (stats != nullptr)
+        {
+            // the tokens are lexed while parsing, which has the time, and
+            // only ever held a batch at a time
+            stats->record(Phase::Lex, 0, l.tokensStreamed(), 0);
+        }
+    }
+    if (stats != nullptr)
+    {
+        (*stats)[Phase::Parse].count += countNodes(*program); // counted outside the timing
+    }
+    if (options.fold)
+    {
+        PhaseTimer fold = PhaseTimer(stats, Phase::Fold);
+        size_t before = program->bytesUsed();
+        uint64_t removed = foldConstants(*program);
+        fold.done(removed, program->bytesUsed() - before);
+    }
+    if (options.emitAst)
+    {
+        if (path == "-")
+        {
+            throw std::runtime_error("--emit-ast needs a file to write next to");
+        }
+        PhaseTimer output = PhaseTimer(stats, Phase::Output);
+        writeAstFile(FlatAst(*program), path + ".ast");
+        output.done();
+        return;
+    }
+    if (cache != nullptr)
+    {
+        PhaseTimer store = PhaseTimer(stats, Phase::Cache);
+        cache->store(file.view(), FlatAst(*program));
+        store.done();
+    }
+    PhaseTimer output = PhaseTimer(stats, Phase::Output);
+    size_t before = out.size();
+    program->toJSON(out);
+    output.done(0, out.size() - before);
+}
+
+int main(int argc, char** argv) {
+
+    // paths, directories, or - for standard input
+    std::vector<std::string> paths;
+    Options options;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--compact")
+        {
+            options.compact = true;
+        }
+        else if (arg == "--emit-ast")
+        {
+            options.emitAst = true;
+        }
+        else if (arg == "--cache" && i + 1 < argc)
+        {
+            options.cacheDirectory = argv[++i];
+        }
+        else if (arg == "--cache-size" && i + 1 < argc)
+        {
+            if (!parse_count(argv[++i], options.cacheLimit)) // megabytes
+            {
+                std::cerr << "--cache-size expects a number of megabytes, not " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--cache-stats")
+        {
+            options.cacheStats = true;
+        }
+        else if (arg == "--parallel-parse")
+        {
+            options.parallelParse = true;
+        }
+        else if (arg == "--parallel-lex")
+        {
+            options.parallelLex = true;
+        }
+        else if (arg == "--fold")
+        {
+            options.fold = true;
+        }
+        else if (arg == "--stats" || arg == "--stats=table" || arg == "--stats=json")
+        {
+            options.stats = arg == "--stats=json" ? "json" : "table";
+        }
+        else if ((arg == "--jobs" || arg == "-j") && i + 1 < argc)
+        {
+            uint64_t jobs;
+            if (!parse_count(argv[++i], jobs) || jobs > 4096)
+            {
+                std::cerr << arg << " expects a number of threads up to 4096, not " << argv[i] << std::endl;
+                return 1;
+            }
+            options.jobs = std::max<unsigned>(1, jobs);
+        }
+        else
+        {
+            paths.push_back(arg);
+        }
+    }
+    if (paths.empty())
+    {
+        paths.push_back("src/examples/test.mu");
+    }
+
+    std::vector<std::string> files;
+    for (const std::string& path : paths)
+    {
+        collect(path, files);
+    }
+
+    std::optional<ParseCache> cache;
+    int status = 0;
+    try
+    {
+        if (!options.cacheDirectory.empty() && !options.emitAst)
+        {
+            cache.emplace(options.cacheDirectory, options.cacheLimit * 1024 * 1024, options.fold ? "fold " + std::to_string(fold_version) : "");
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    ParseCache* shared = cache ? &*cache : nullptr;
+    // one per input, so threads never share them
+    std::vector<Stats> stats(options.stats.empty() ? 0 : files.size());
+    auto started = std::chrono::steady_clock::now();
+
+    if (files.size() == 1)
+    {
+        // stream straight to stdout
+        try
+        {
+            std::optional<ThreadPool> pool;
+            if (options.parallelParse || options.parallelLex)
+            {
+                pool.emplace(options.jobs - 1);
+            }
+            JsonWriter out = JsonWriter(STDOUT_FILENO, !options.compact);
+            compile(files[0], out, options, shared, pool ? &*pool : nullptr, stats.empty() ? nullptr : &stats[0]);
+            out.flush();
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << files[0] << ": " << e.what() << std::endl;
+            status = 1;
+        }
+        catch (...)
+        {
+            std::cerr << files[0] << ": Unknown error" << std::endl;
+            status = 1;
+        }
+    }
+    else
+    {
+        // one document per input, printed in input order whichever finishes first
+        std::vector<std::string> outputs(files.size());
+        std::vector<std::string> errors(files.size());
+        {
+            ThreadPool pool = ThreadPool(options.parallelParse || options.parallelLex ? options.jobs - 1 : std::min<size_t>(options.jobs - 1, files.size()));
+            TaskGroup group = TaskGroup(pool);
+            for (size_t i = 0; i < files.size(); i++)
+            {
+                group.run([&, i]
+                {
+                    try
+                    {
+                        JsonWriter out = JsonWriter(!options.compact);
+                        compile(files[i], out, options, shared, &pool, stats.empty() ? nullptr : &stats[i]);
+                        outputs[i] = out.str();
+                    }
+                    catch (const std::exception& e)
+                    {
+                        errors[i] = e.what();
+                    }
+                    catch (...)
+                    {
+                        // anything else thrown still only fails this input
+                        errors[i] = "Unknown error";
+                    }
+                });
+            }
+            group.wait();
+        }
+        for (size_t i = 0; i < files.size(); i++)
+        {
+            if (!errors[i].empty())
+            {
+                std::cout.flush();
+                std::cerr << files[i] << ": " << errors[i] << std::endl;
+                status = 1;
+                continue;
+            }
+            std::cout << outputs[i];
+            if (options.compact && !outputs[i].empty())
+            {
+                std::cout << "\n"; // one document per line
+            }
+        }
+        std::cout.flush();
+    }
+
+    if (cache)
+    {
+        cache->trim();
+        if (options.cacheStats)
+        {
+            report(*cache);
+        }
+    }
+    if (!stats.empty())
+    {
+        std::chrono::duration<double> wall = std::chrono::steady_clock::now() - started;
+        Stats total;
+        for (const Stats& input : stats)
+        {
+            total.add(input);
+        }
+        if (options.stats == "json")
+        {
+            JsonWriter out = JsonWriter(STDERR_FILENO, false);
+            total.toJSON(out, wall.count());
+            out.flush();
+            std::cerr << std::endl;
+        }
+        else
+        {
+            total.print(std::cerr, wall.count());
+        }
+    }
+    return status;
+}
@@ -4,87 +4,216 @@
 #include "includes/parser.hpp"
 #include "includes/span.hpp"
 #include <iostream>
+#include <charconv>
+#include <algorithm>
 
-Parser::Parser(std::vector<Token> tokens)
+Parser::Parser(std::vector<Token> tokens, const Source& source, std::shared_ptr<SymbolTable> symbols) : stream(std::move(tokens)), source(source), symbols(std::move(symbols))
 {
-    this->tokens = tokens;
-    this->index = 0;
-    this->current_token = this->tokens[this->index];
+    if (this->symbols == nullptr)
+    {
+        this->symbols = std::make_shared<SymbolTable>();
+    }
+    this->recent.fill({std::string_view(), empty_symbol});
+    this->current_token = this->stream.peek();
+};
+
+Parser::Parser(Lexer& lexer, const Source& source, std::shared_ptr<SymbolTable> symbols) : stream(lexer), source(source), symbols(std::move(symbols))
+{
+    if (this->symbols == nullptr)
+    {
+        this->symbols = std::make_shared<SymbolTable>();
+    }
+    this->recent.fill({std::string_view(), empty_symbol});
+    this->current_token = this->stream.peek();
 };
 
 std::unique_ptr<Program> Parser::parse()
 {
-    LineColumn span_start = this->current_token.pointer;
-    std::vector<std::unique_ptr<Statement>> program = parse_statements();
-    LineColumn span_end = this->current_token.pointer;
-    return std::make_unique<Program>(std::move(program), (Span){span_start, span_end});
+    LineColumn span_start = this->position();
+    std::vector<Statement*> program = parse_statements();
+    LineColumn span_end = this->position();
+    ArenaArray<Statement*> statements = this->arena.array(program);
+    return std::make_unique<Program>(std::move(this->arena), statements, (Span){span_start, span_end}, this->symbols);
 };
 
-// utility
+// smallest run of tokens worth handing to another thread
+static const size_t minimum_piece = 4096;
 
-// looks ahead to see if there is a sequence of tokens
-bool Parser::lookahead(std::vector<TokenType> tokens)
+std::unique_ptr<Program> Parser::parse(ThreadPool& pool)
 {
-    for (int i = 0; i < tokens.size(); i++)
+    const std::vector<Token>& tokens = this->stream.lexed();
+    if (tokens.empty())
     {
-        if (!(tokens[i] == this->tokens[this->index + i].type))
+        return this->parse();
+    }
+    std::vector<size_t> starts = top_level_starts(tokens);
+    size_t end = tokens.size() - 1; // EoF
+    size_t piece = std::max(minimum_piece, end / (4 * (pool.workers() + 1)));
+
+    // cut at the first statement start past every multiple of the piece size
+    std::vector<size_t> cuts = {0};
+    for (size_t start : starts)
+    {
+        if (start - cuts.back() >= piece)
         {
-            return false;
+            cuts.push_back(start);
         }
     }
+    if (cuts.size() < 2)
+    {
+        return this->parse();
+    }
+    cuts.push_back(end);
 
-    return true;
+    // every piece gets its own parser and arena, stitched together in order
+    size_t pieces = cuts.size() - 1;
+    std::vector<std::unique_ptr<Parser>> parsers(pieces);
+    std::vector<std::vector<Statement*>> statements(pieces);
+    std::vector<std::exception_ptr> errors(pieces);
+    {
+        TaskGroup group = TaskGroup(pool);
+        for (size_t i = 0; i < pieces; i++)
+        {
+            group.run([&, i]
+            {
+                try
+                {
+                    std::vector<Token> slice(tokens.begin() + cuts[i], tokens.begin() + cuts[i + 1]);
+                    // ended where the next piece begins, so spans come out as in a serial parse
+                    slice.push_back({tokens[cuts[i + 1]].offset, 0, TokenType::EoF});
+                    parsers[i] = std::make_unique<Parser>(std::move(slice), this->source, this->symbols);
+                    statements[i] = parsers[i]->parse_statements();
+                }
+                catch (...)
+                {
+                    errors[i] = std::current_exception();
+                }
+            });
+        }
+        group.wait();
+    }
+    // the error the serial parser would have stopped at
+    for (std::exception_ptr error : errors)
+    {
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+    std::vector<Statement*> program;
+    for (size_t i = 0; i < pieces; i++)
+    {
+        program.insert(program.end(), statements[i].begin(), statements[i].end());
+        this->arena.adopt(std::move(parsers[i]->arena));
+    }
+    Span span = {this->source.position(tokens.front()), this->source.position(tokens[end])};
+    ArenaArray<Statement*> items = this->arena.array(program);
+    return std::make_unique<Program>(std::move(this->arena), items, span, this->symbols);
+};
+
+std::vector<Statement*> Parser::parse_top_level(Arena& into)
+{
+    std::vector<Statement*> statements = parse_statements();
+    into.adopt(std::move(this->arena));
+    return statements;
 };
 
-std::string Parser::consume(int repetitions)
+// utility
+
+// most names repeat, so a small cache keyed on length and first and last
+// characters answers most lookups without taking the shared table's lock
+Symbol Parser::symbol(std::string_view text)
 {
-    std::string res = this->current_token.value;
+    if (text.empty())
+    {
+        return empty_symbol;
+    }
+    size_t slot = (text.size() * 31 + (unsigned char)text.front() * 7 + (unsigned char)text.back()) % this->recent.size();
+    RecentSymbol& cached = this->recent[slot];
+    if (cached.text != text)
+    {
+        cached = {text, this->symbols->intern(text)};
+    }
+    return cached.symbol;
+};
+
+std::string_view Parser::consume(int repetitions)
+{
+    std::string_view res = this->text();
     for (int i = 0; i<repetitions; i++)
     {
         if (this->current_token.type != TokenType::EoF)
         {
-            ++this->index;
-            this->current_token = this->tokens[this->index];
+            this->stream.advance();
+            this->current_token = this->stream.peek();
         }
     }
     return res;
 };
 
+std::string_view Parser::text()
+{
+    return this->source.text(this->current_token);
+};
+
+LineColumn Parser::position()
+{
+    return this->source.position(this->current_token);
+};
+
 void Parser::check_and_consume(TokenType expected_token_type)
 {
     if (this->current_token.type != expected_token_type && this->current_token.type != TokenType::EoF)
     {
-        throw std::runtime_error("Unexpected token: {" + this->current_token.value + "}");
+        throw std::runtime_error("Unexpected token: {" + std::string(this->text()) + "}");
     }
     this->consume();
 };
 
-int Parser::check_precedence()
+std::vector<size_t> Parser::top_level_starts(const std::vector<Token>& tokens)
 {
-    std::map<std::string, int>::iterator iter = precedence_map.find(current_token.value);
-    if (iter != precedence_map.end() )
+    std::vector<size_t> starts;
+    int depth = 0;
+    for (size_t i = 0; i + 1 < tokens.size(); i++)
     {
-        return iter->second;
-    } 
-    else {
-        return -1;
+        TokenType type = tokens[i].type;
+        if (type == TokenType::INDENT)
+        {
+            depth++;
+        }
+        else if (type == TokenType::DEDENT)
+        {
+            depth--;
+        }
+        if (depth != 0 || (type != TokenType::EoL && type != TokenType::DEDENT))
+        {
+            continue;
+        }
+        TokenType next = tokens[i + 1].type;
+        if (next != TokenType::ELSE && next != TokenType::INDENT && next != TokenType::DEDENT && next != TokenType::EoF)
+        {
+            starts.push_back(i + 1);
+        }
     }
+    return starts;
 };
 
+// called on `ID (`, a definition follows its parameter list with `=`, `:` or an indented block
 bool Parser::check_if_func_def() 
 {
-
-    int i = this->index;
-    while (tokens[i].type != TokenType::RPAREN)
+    size_t i = this->stream.closing(1);
+    if (i == TokenStream::unmatched)
     {
-        i++;
+        return false;
     }
     ++i;
-    if (tokens[i].type == TokenType::ASSIGN || tokens[i].type == TokenType::TYPE_DECL)
+    TokenType after = this->stream.peek(i).type;
+    if (after == TokenType::ASSIGN || after == TokenType::TYPE_DECL)
     {
         return true;
     }
-    else if (tokens[i].type == TokenType::EoL && tokens[i+1].type == TokenType::INDENT)
+    else if (after == TokenType::EoL && this->stream.peek(i + 1).type == TokenType::INDENT)
     {
         return true;
     }
@@ -96,68 +225,67 @@ bool Parser::check_if_func_def()
  
 bool Parser::check_if_list_comp() 
 { 
-    int i = this->index;
-    while(tokens[i].type != TokenType::RSQUARE) 
-    {
-        if (tokens[i].type == TokenType::FOR) 
-            return true;
-        ++i;
-    }
-    return false;
+    return this->stream.form(0) == TokenType::FOR;
 };
 
 bool Parser::check_if_generator() 
 { 
-    int i = this->index;
-    while(tokens[i].type != TokenType::RSQUARE) 
-    {
-        if (tokens[i].type == TokenType::ELIPSIS) 
-            return true;
-        ++i;
-    }
-    return false;
+    return this->stream.form(0) == TokenType::ELIPSIS;
 };
 
 Span Parser::current_span()
 {
-    return {this->current_token.pointer, this->current_token.pointer};
+    return {this->position(), this->position()};
 };
 
 // Statements
 
-std::unique_ptr<StatementBlock> Parser::parse_statement_block()
+StatementBlock* Parser::parse_statement_block()
 {
-    LineColumn span_start = this->current_token.pointer;
+    LineColumn span_start = this->position();
     this->check_and_consume(TokenType::INDENT);
-    std::vector<std::unique_ptr<Statement>> statements = this->parse_statements(TokenType::DEDENT);
+    size_t mark = this->openList();
+    this->collect_statements(TokenType::DEDENT);
+    ArenaArray<Statement*> statements = this->closeList<Statement>(mark);
     this->consume(); // DEDENT or EoF
-    LineColumn span_end = this->current_token.pointer;
-    return std::make_unique<StatementBlock>(std::move(statements), (Span){span_start, span_end});
+    LineColumn span_end = this->position();
+    return this->arena.make<StatementBlock>(statements, (Span){span_start, span_end});
+};
+
+std::vector<Statement*> Parser::parse_statements()
+{
+    this->collect_statements(TokenType::EoF);
+    std::vector<Statement*> statements;
+    statements.reserve(this->pending.size());
+    for (Node* statement : this->pending)
+    {
+        statements.push_back(static_cast<Statement*>(statement));
+    }
+    this->pending.clear();
+    return statements;
 };
 
-std::vector<std::unique_ptr<Statement>> Parser::parse_statements(TokenType end_token)
+void Parser::collect_statements(TokenType end_token)
 {
-    std::vector<std::unique_ptr<Statement>> statements;
     while(this->current_token.type != end_token && this->current_token.type != TokenType::EoF)
     {
-        statements.push_back(this->parse_statement());
+        this->pending.push_back(this->parse_statement());
     };
-    return statements;
 };
 
-std::unique_ptr<Statement> Parser::parse_statement()
+Statement* Parser::parse_statement()
 {
-    if (lookahead({TokenType::ID, TokenType::TYPE_DECL, TokenType::ID, TokenType::ASSIGN}) || lookahead({TokenType::ID, TokenType::ASSIGN}))
+    if (lookahead<TokenType::ID, TokenType::TYPE_DECL, TokenType::ID, TokenType::ASSIGN>() || lookahead<TokenType::ID, TokenType::ASSIGN>())
     {
         return parse_assignment();
     }
-    else if (lookahead({TokenType::ID, TokenType::LPAREN}))
+    else if (lookahead<TokenType::ID, TokenType::LPAREN>())
     {
         if (check_if_func_def())
         {
             return parse_function_defenition();
         } else {
-            std::unique_ptr<Expression> e = parse_expression();
+            Expression* e = parse_expression();
             check_and_consume(TokenType::EoL);
             return e;
         }
@@ -184,153 +312,153 @@ std::unique_ptr<Statement> Parser::parse_statement()
     }
 };
 
-std::unique_ptr<Assignment> Parser::parse_assignment()
+Assignment* Parser::parse_assignment()
 {
-    LineColumn span_start = this->current_token.pointer;
-    std::string name = this->current_token.value;
-    std::string type = "";
+    LineColumn span_start = this->position();
+    Symbol name = this->symbol(this->text());
+    Symbol type = empty_symbol;
     consume();
     if (current_token.type==TokenType::TYPE_DECL)
     {
         consume(); // consume :
-        type = this->current_token.value;
+        type = this->symbol(this->text());
         consume(); // consume typedef
     }
     consume(); // consume =
-    std::unique_ptr<Expression> rhs = parse_expression();
-    LineColumn span_end = this->current_token.pointer;
-    std::unique_ptr<Assignment> assignment = std::make_unique<Assignment>(name, type, std::move(rhs), (Span){span_start, span_end});
+    Expression* rhs = parse_expression();
+    LineColumn span_end = this->position();
+    Assignment* assignment = this->arena.make<Assignment>(name, type, rhs, (Span){span_start, span_end});
     check_and_consume(TokenType::EoL);
     return assignment;
 };
 
-std::unique_ptr<FunctionDefenition> Parser::parse_function_defenition()
+FunctionDefenition* Parser::parse_function_defenition()
 {
-    LineColumn span_start = this->current_token.pointer;
-    std::unique_ptr<FunctionPrototype> prototype = parse_function_prototype();
+    LineColumn span_start = this->position();
+    FunctionPrototype* prototype = parse_function_prototype();
     if (this->current_token.type == TokenType::ASSIGN)
     {
-        std::unique_ptr<Statement> body = parse_return_statement();
-        LineColumn span_end = this->current_token.pointer;
-        return std::make_unique<FunctionDefenition>(std::move(prototype), std::move(body), (Span){span_start, span_end});
+        Statement* body = parse_return_statement();
+        LineColumn span_end = this->position();
+        return this->arena.make<FunctionDefenition>(prototype, body, (Span){span_start, span_end});
     }
-    else if (lookahead({TokenType::EoL, TokenType::INDENT}))
+    else if (lookahead<TokenType::EoL, TokenType::INDENT>())
     {
         consume();
-        std::unique_ptr<StatementBlock> body = parse_statement_block();
-        LineColumn span_end = this->current_token.pointer;
-        return std::make_unique<FunctionDefenition>(std::move(prototype), std::move(body), (Span){span_start, span_end});
+        StatementBlock* body = parse_statement_block();
+        LineColumn span_end = this->position();
+        return this->arena.make<FunctionDefenition>(prototype, body, (Span){span_start, span_end});
     }
     else
     {
-        throw "something";
+        throw std::runtime_error("Expected = or an indented body after a function prototype, got " + std::string(this->text()));
     }
 };
 
-std::unique_ptr<FunctionPrototype> Parser::parse_function_prototype()
+FunctionPrototype* Parser::parse_function_prototype()
 {
-    LineColumn span_start = this->current_token.pointer;
-    std::string name = this->current_token.value;
-    std::string return_type = "";
+    LineColumn span_start = this->position();
+    Symbol name = this->symbol(this->text());
+    Symbol return_type = empty_symbol;
     consume(2);
-    std::vector<std::unique_ptr<Parameter>> parameters = {};
+    size_t mark = this->openList();
     while (this->current_token.type!=TokenType::RPAREN)
     {
-        parameters.push_back(parse_parameter());
+        this->pending.push_back(parse_parameter());
         if (this->current_token.type == TokenType::COMMA)
         {   
             consume();
         }
     }
     consume();
+    ArenaArray<Parameter*> parameters = this->closeList<Parameter>(mark);
 
     if (this->current_token.type == TokenType::TYPE_DECL)
     {
         consume();
-        return_type = this->current_token.value;
+        return_type = this->symbol(this->text());
         check_and_consume(TokenType::ID);
     }
     
-    LineColumn span_end = this->current_token.pointer;
-    return std::make_unique<FunctionPrototype>(name, std::move(parameters), return_type, (Span){span_start, span_end});
+    LineColumn span_end = this->position();
+    return this->arena.make<FunctionPrototype>(name, parameters, return_type, (Span){span_start, span_end});
 };
 
-std::unique_ptr<Parameter> Parser::parse_parameter()
+Parameter* Parser::parse_parameter()
 {        
-    LineColumn span_start = this->current_token.pointer;
+    LineColumn span_start = this->position();
 
-    std::string name = this->current_token.value;
+    Symbol name = this->symbol(this->text());
     check_and_consume(TokenType::ID);
     check_and_consume(TokenType::TYPE_DECL);
-    std::string type = this->current_token.value;
+    Symbol type = this->symbol(this->text());
     check_and_consume(TokenType::ID);
-    LineColumn span_end = this->current_token.pointer;
-    return std::make_unique<Parameter>(name, type, (Span){span_start, span_end});
+    LineColumn span_end = this->position();
+    return this->arena.make<Parameter>(name, type, (Span){span_start, span_end});
 };
 
 
-std::unique_ptr<Statement> Parser::parse_return_statement()
+Statement* Parser::parse_return_statement()
 {
-    LineColumn span_start = this->current_token.pointer;
+    LineColumn span_start = this->position();
     consume();
-    std::unique_ptr<Expression> expression = parse_expression();
-    LineColumn span_end = this->current_token.pointer;
+    Expression* expression = parse_expression();
+    LineColumn span_end = this->position();
     check_and_consume(TokenType::EoL);
-    return std::make_unique<ReturnStatement>(std::move(expression), (Span){span_start, span_end});
+    return this->arena.make<ReturnStatement>(expression, (Span){span_start, span_end});
 };
 
 
-std::unique_ptr<IfStatement> Parser::parse_if_statement()
+IfStatement* Parser::parse_if_statement()
 {
-    LineColumn span_start = this->current_token.pointer;
+    LineColumn span_start = this->position();
     consume();
-    std::unique_ptr<Expression> conditional = parse_expression();
+    Expression* conditional = parse_expression();
     check_and_consume(TokenType::EoL);
-    std::unique_ptr<StatementBlock> ifBlock = parse_statement_block();
-    LineColumn span_end = this->current_token.pointer;
-    std::unique_ptr<StatementBlock> elseBlock = std::make_unique<StatementBlock>((std::vector<std::unique_ptr<Statement>>){}, current_span());
+    StatementBlock* ifBlock = parse_statement_block();
+    LineColumn span_end = this->position();
+    StatementBlock* elseBlock = this->arena.make<StatementBlock>(ArenaArray<Statement*>(), current_span());
 
-    if (lookahead({TokenType::ELSE, TokenType::IF}))
+    if (lookahead<TokenType::ELSE, TokenType::IF>())
     {
         consume();
-        std::unique_ptr<IfStatement> nestedIf = parse_if_statement();
+        IfStatement* nestedIf = parse_if_statement();
         Span span = nestedIf->span;
-        std::vector<std::unique_ptr<Statement>> statements;
-        statements.push_back(std::move(nestedIf));
-        elseBlock = std::make_unique<StatementBlock>(std::move(statements), span);
-    } else if (lookahead({TokenType::ELSE, TokenType::EoL, TokenType::INDENT}))
+        ArenaArray<Statement*> statements = {this->arena.make<Statement*>(nestedIf), 1};
+        elseBlock = this->arena.make<StatementBlock>(statements, span);
+    } else if (lookahead<TokenType::ELSE, TokenType::EoL, TokenType::INDENT>())
     {
         consume(2);
         elseBlock = parse_statement_block();
     }
-    span_end = this->current_token.pointer;
+    span_end = this->position();
 
-    return std::make_unique<IfStatement>(std::move(conditional), std::move(ifBlock), std::move(elseBlock), (Span){span_start, span_end});
+    return this->arena.make<IfStatement>(conditional, ifBlock, elseBlock, (Span){span_start, span_end});
 };
 
 
-std::unique_ptr<WhileLoop> Parser::parse_while_loop()
+WhileLoop* Parser::parse_while_loop()
 {
-    LineColumn span_start = this->current_token.pointer;
+    LineColumn span_start = this->position();
     consume();
 
-    std::unique_ptr<Expression> conditional = parse_expression();
+    Expression* conditional = parse_expression();
     check_and_consume(TokenType::EoL);
-    std::unique_ptr<StatementBlock> block = parse_statement_block();
-    LineColumn span_end = this->current_token.pointer;
-    return std::make_unique<WhileLoop>(std::move(conditional), std::move(block), (Span){span_start, span_end});
+    StatementBlock* block = parse_statement_block();
+    LineColumn span_end = this->position();
+    return this->arena.make<WhileLoop>(conditional, block, (Span){span_start, span_end});
 };
 
-std::unique_ptr<ForLoop> Parser::parse_for_loop()
+ForLoop* Parser::parse_for_loop()
 {
-    LineColumn span_start = this->current_token.pointer;
+    LineColumn span_start = this->position();
     consume();
-    std::vector<std::unique_ptr<Identifier>> ids = {};
-    std::unique_ptr<Value> iterable;
-    while(!lookahead({TokenType::IN}))
+    size_t mark = this->openList();
+    Value* iterable;
+    while(!lookahead<TokenType::IN>())
     {
-        ids.push_back(parse_identifier());
-        if (lookahead({TokenType::COMMA}))
+        this->pending.push_back(parse_identifier());
+        if (lookahead<TokenType::COMMA>())
         {
             consume();
         }
@@ -340,7 +468,8 @@ std::unique_ptr<ForLoop> Parser::parse_for_loop()
         }
     }
     check_and_consume(TokenType::IN);
-    if (lookahead({TokenType::LSQUARE}))
+    ArenaArray<Identifier*> ids = this->closeList<Identifier>(mark);
+    if (lookahead<TokenType::LSQUARE>())
     {
         iterable = parse_iterable();
     } 
@@ -349,131 +478,133 @@ std::unique_ptr<ForLoop> Parser::parse_for_loop()
         iterable = parse_identifier();
     }
     check_and_consume(TokenType::EoL);
-    std::unique_ptr<StatementBlock> body = parse_statement_block();
+    StatementBlock* body = parse_statement_block();
 
-    LineColumn span_end = this->current_token.pointer;
-    return std::make_unique<ForLoop>(std::move(ids), std::move(iterable), std::move(body), (Span){span_start, span_end});
+    LineColumn span_end = this->position();
+    return this->arena.make<ForLoop>(ids, iterable, body, (Span){span_start, span_end});
 
 };
 
 // Expressions
 
-std::unique_ptr<Expression> Parser::parse_expression()
+Expression* Parser::parse_expression()
 {
-    std::unique_ptr<Expression> lhs = parse_unary();
-    return parse_binary_expression(0, std::move(lhs));
+    Expression* lhs = parse_unary();
+    return parse_binary_expression(0, lhs);
 };
 
-std::unique_ptr<Expression> Parser::parse_primary()
+Expression* Parser::parse_primary()
 {
-    if (lookahead({TokenType::ID, TokenType::LPAREN}))
+    if (lookahead<TokenType::ID, TokenType::LPAREN>())
     {
         return parse_function_call();
     }
-    else if (lookahead({TokenType::ID, TokenType::PERIOD}))
+    else if (lookahead<TokenType::ID, TokenType::PERIOD>())
     {
         return parse_attribute_reference();
     }
-    else if (lookahead({TokenType::LPAREN}))
+    else if (lookahead<TokenType::LPAREN>())
     {
         return parse_parenthesis();
     }
-    else if (lookahead({TokenType::LSQUARE}))
+    else if (lookahead<TokenType::LSQUARE>())
     {
         return parse_iterable();
     }
-    else if (lookahead({TokenType::NUMBER}))
+    else if (lookahead<TokenType::NUMBER>())
     {
         return parse_numeric_literal();
     }
-    else if (lookahead({TokenType::STRING}))
+    else if (lookahead<TokenType::STRING>())
     {
         return parse_string_literal();
     }
-    else if (lookahead({TokenType::BOOL}))
+    else if (lookahead<TokenType::BOOL>())
     {
         return parse_boolean_literal();
     }
-    else if (lookahead({TokenType::ID}))
+    else if (lookahead<TokenType::ID>())
     {
         return parse_identifier();
     }
     else 
     {
-        throw std::runtime_error("Unexpected token " + this->current_token.value);
+        throw std::runtime_error("Unexpected token " + std::string(this->text()));
     }
 };
 
-std::unique_ptr<Expression> Parser::parse_unary()
+Expression* Parser::parse_unary()
 {
     // this function is for unary operators
     return parse_primary();
 };
 
-std::unique_ptr<Expression> Parser::parse_binary_expression(int precedence, std::unique_ptr<Expression> lhs)
+// precedence climbing on the operator table, a right-associative operator
+// takes a following one of the same precedence into its rhs
+Expression* Parser::parse_binary_expression(int precedence, Expression* lhs)
 {
-    int current_precedence = check_precedence();
     while(true)
     {
-        LineColumn span_start = current_token.pointer;
-        current_precedence = check_precedence();
-        if(current_precedence < precedence)
+        LineColumn span_start = position();
+        const OperatorInfo& current = binary_operator(this->current_token.type);
+        if(current.precedence < precedence)
             return lhs;
-        std::string op = this->current_token.value;
         consume();
-        std::unique_ptr<Expression> rhs = parse_unary();
-        int next_precedence = check_precedence();
-        if (current_precedence < next_precedence)
+        Expression* rhs = parse_unary();
+        const OperatorInfo& next = binary_operator(this->current_token.type);
+        bool right = current.associativity == Associativity::Right;
+        if (current.precedence < next.precedence || (right && current.precedence == next.precedence))
         {
-            rhs = parse_binary_expression(current_precedence + 1, std::move(rhs));
+            rhs = parse_binary_expression(right ? current.precedence : current.precedence + 1, rhs);
         }
-        LineColumn span_end = current_token.pointer;
-        lhs = std::make_unique<BinaryExpression>(std::move(lhs), std::move(rhs), op, (Span){span_start, span_end});
+        LineColumn span_end = position();
+        lhs = this->arena.make<BinaryExpression>(lhs, rhs, current.op, (Span){span_start, span_end});
     }
 };
 
 
-std::unique_ptr<Expression> Parser::parse_parenthesis()
+Expression* Parser::parse_parenthesis()
 {
     consume();
-    std::unique_ptr<Expression> expression = parse_expression();
+    Expression* expression = parse_expression();
     check_and_consume(TokenType::RPAREN);
     return expression;
 };
 
-std::unique_ptr<FunctionCall> Parser::parse_function_call()
+FunctionCall* Parser::parse_function_call()
 {
-    LineColumn span_start = this->current_token.pointer;
-    std::string name = this->current_token.value;
+    LineColumn span_start = this->position();
+    Symbol name = this->symbol(this->text());
     check_and_consume(TokenType::ID);
     check_and_consume(TokenType::LPAREN);
-    std::vector<std::unique_ptr<Expression>> args = {};
-    while(!lookahead({TokenType::RPAREN}))
+    size_t mark = this->openList();
+    while(!lookahead<TokenType::RPAREN>())
     {
-        args.push_back(parse_expression());
-        if (!lookahead({TokenType::COMMA}))
+        this->pending.push_back(parse_expression());
+        if (!lookahead<TokenType::COMMA>())
         {
             break;
         }
         consume();
     }
+    ArenaArray<Expression*> args = this->closeList<Expression>(mark);
     check_and_consume(TokenType::RPAREN);
-    LineColumn span_end = this->current_token.pointer;
+    LineColumn span_end = this->position();
 
-    return std::make_unique<FunctionCall>(name, std::move(args), (Span){span_start, span_end});
+    return this->arena.make<FunctionCall>(name, args, (Span){span_start, span_end});
 };
 
-std::unique_ptr<ListComprehension> Parser::parse_list_comprehension()
+ListComprehension* Parser::parse_list_comprehension()
 {
-    LineColumn span_start = this->current_token.pointer;
+    LineColumn span_start = this->position();
     consume();
-    std::unique_ptr<Expression> result = parse_expression();
+    Expression* result = parse_expression();
     check_and_consume(TokenType::FOR);
-    std::vector<std::unique_ptr<Identifier>> ids = {};
-    while(!lookahead({TokenType::IN}))
+    size_t mark = this->openList();
+    while(!lookahead<TokenType::IN>())
     {
-        ids.push_back(parse_identifier());
-        if (lookahead({TokenType::COMMA}))
+        this->pending.push_back(parse_identifier());
+        if (lookahead<TokenType::COMMA>())
         {
             consume();
         }
@@ -483,9 +614,10 @@ std::unique_ptr<ListComprehension> Parser::parse_list_comprehension()
         }
     }
     check_and_consume(TokenType::IN);
-    std::unique_ptr<Value> iterable;
+    ArenaArray<Identifier*> ids = this->closeList<Identifier>(mark);
+    Value* iterable;
 
-    if (lookahead({TokenType::LSQUARE}))
+    if (lookahead<TokenType::LSQUARE>())
     {
         iterable = parse_iterable();
     } 
@@ -494,56 +626,57 @@ std::unique_ptr<ListComprehension> Parser::parse_list_comprehension()
         iterable = parse_identifier();
     }
 
-    std::unique_ptr<Expression> filter = std::make_unique<BooleanLiteral>(true, current_span());
-    if (lookahead({TokenType::IF}))
+    Expression* filter = this->arena.make<BooleanLiteral>(true, current_span());
+    if (lookahead<TokenType::IF>())
     {
         consume();
         filter = parse_expression();
     }
     check_and_consume(TokenType::RSQUARE);
-    LineColumn span_end = this->current_token.pointer;
-    return std::make_unique<ListComprehension>(std::move(result), std::move(ids), std::move(iterable), std::move(filter), (Span){span_start, span_end});
+    LineColumn span_end = this->position();
+    return this->arena.make<ListComprehension>(result, ids, iterable, filter, (Span){span_start, span_end});
 };
 
-std::unique_ptr<Generator> Parser::parse_generator()
+Generator* Parser::parse_generator()
 {
-    LineColumn span_start = this->current_token.pointer;
+    LineColumn span_start = this->position();
     consume();
-    std::unique_ptr<Expression> start = parse_expression();
-    std::unique_ptr<Expression> step = std::make_unique<NumericLiteral>(1, current_span());
-    if (lookahead({TokenType::COMMA}))
+    Expression* start = parse_expression();
+    Expression* step = this->arena.make<NumericLiteral>(1, current_span());
+    if (lookahead<TokenType::COMMA>())
     {
         consume();
         step = parse_expression();
     }
     check_and_consume(TokenType::ELIPSIS);
-    std::unique_ptr<Expression> stop = parse_expression();
+    Expression* stop = parse_expression();
     check_and_consume(TokenType::RSQUARE);
-    LineColumn span_end = this->current_token.pointer;
+    LineColumn span_end = this->position();
 
-    return std::make_unique<Generator>(std::move(start), std::move(step), std::move(stop), (Span){span_start, span_end});
+    return this->arena.make<Generator>(start, step, stop, (Span){span_start, span_end});
 };
 
-std::unique_ptr<IterableLiteral> Parser::parse_literal_iterable()
+IterableLiteral* Parser::parse_literal_iterable()
 {
-    LineColumn span_start = this->current_token.pointer;
+    LineColumn span_start = this->position();
     consume();
-    std::vector<std::unique_ptr<Expression>> values;
+    size_t mark = this->openList();
     while (this->current_token.type != TokenType::RSQUARE)
     {
-        values.emplace_back(std::move(parse_expression()));
+        this->pending.push_back(parse_expression());
         if (current_token.type == TokenType::COMMA)
         {
             consume();
         }
     }
-    LineColumn span_end = this->current_token.pointer;
+    ArenaArray<Expression*> values = this->closeList<Expression>(mark);
+    LineColumn span_end = this->position();
     consume();
-    return std::make_unique<IterableLiteral>(std::move(values), (Span){span_start, span_end});
+    return this->arena.make<IterableLiteral>(values, (Span){span_start, span_end});
 
 }
 
-std::unique_ptr<Iterable> Parser::parse_iterable()
+Iterable* Parser::parse_iterable()
 {
 
     
@@ -560,9 +693,9 @@ std::unique_ptr<Iterable> Parser::parse_iterable()
     
 };
 
-std::unique_ptr<Identifier> Parser::parse_identifier()
+Identifier* Parser::parse_identifier()
 {
-    std::unique_ptr<Identifier> id = std::make_unique<Identifier>(this->current_token.value, current_span());
+    Identifier* id = this->arena.make<Identifier>(this->symbol(this->text()), current_span());
     check_and_consume(TokenType::ID);
     return id;
 };
@@ -572,47 +705,50 @@ std::unique_ptr<Identifier> Parser::parse_identifier()
 //     return Slice()
 // };
 
-std::unique_ptr<Subscription> Parser::parse_iterable_subscription()
+Subscription* Parser::parse_iterable_subscription()
 {
-    LineColumn span_start = this->current_token.pointer;
-    std::unique_ptr<Identifier> id = std::make_unique<Identifier>(this->current_token.value, current_span());
+    LineColumn span_start = this->position();
+    Identifier* id = this->arena.make<Identifier>(this->symbol(this->text()), current_span());
     consume(2);
 
-    std::unique_ptr<Expression> index = parse_expression();
+    Expression* index = parse_expression();
     check_and_consume(TokenType::RSQUARE);
 
-    LineColumn span_end = this->current_token.pointer;
-    return std::make_unique<Subscription>(std::move(id),std::move(index), (Span){span_start, span_end});
+    LineColumn span_end = this->position();
+    return this->arena.make<Subscription>(id,index, (Span){span_start, span_end});
 };
 
-std::unique_ptr<Value> Parser::parse_attribute_reference()
+Value* Parser::parse_attribute_reference()
 {
-    LineColumn span_start = this->current_token.pointer;
-    std::unique_ptr<Identifier> object = std::make_unique<Identifier>(this->current_token.value, current_span());
+    LineColumn span_start = this->position();
+    Identifier* object = this->arena.make<Identifier>(this->symbol(this->text()), current_span());
     consume();
-    if (lookahead({TokenType::PERIOD}))
+    if (lookahead<TokenType::PERIOD>())
     {
         consume();
-        std::unique_ptr<Value> reference = parse_attribute_reference();
-        LineColumn span_end = this->current_token.pointer;
-        return std::make_unique<AttributeReference>(std::move(object), std::move(reference), (Span){span_start, span_end}); // span here is broken
+        Value* reference = parse_attribute_reference();
+        LineColumn span_end = this->position();
+        return this->arena.make<AttributeReference>(object, reference, (Span){span_start, span_end}); // span here is broken
     }
     return object;
 };
 
-std::unique_ptr<NumericLiteral> Parser::parse_numeric_literal()
+NumericLiteral* Parser::parse_numeric_literal()
 {
-    return std::make_unique<NumericLiteral>(std::stod(consume()), current_span());
+    std::string_view digits = consume();
+    double value = 0;
+    std::from_chars(digits.data(), digits.data() + digits.size(), value);
+    return this->arena.make<NumericLiteral>(value, current_span());
 };
 
-std::unique_ptr<BooleanLiteral> Parser::parse_boolean_literal()
+BooleanLiteral* Parser::parse_boolean_literal()
 {
-    return std::make_unique<BooleanLiteral>(consume()=="true" ? true : false, current_span());
+    return this->arena.make<BooleanLiteral>(consume()=="true" ? true : false, current_span());
 };
 
-std::unique_ptr<StringLiteral> Parser::parse_string_literal()
+StringLiteral* Parser::parse_string_literal()
 {
-    return std::make_unique<StringLiteral>(consume(), current_span());
+    return this->arena.make<StringLiteral>(this->arena.string(consume()), current_span());
 };
 
 // List Parser::parse_list() {};
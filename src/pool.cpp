@@ -0,0 +1,173 @@
+#include "includes/pool.hpp"
+#include <chrono>
+
+// the pool the calling thread works for and its queue there
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local unsigned current_queue = 0;
+
+ThreadPool::ThreadPool(unsigned workers) : queued(0), stopping(false)
+{
+    for (unsigned i = 0; i <= workers; i++)
+    {
+        this->queues.push_back(std::make_unique<Queue>());
+    }
+    for (unsigned i = 0; i < workers; i++)
+    {
+        this->threads.emplace_back([this, i] { this->work(i); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(this->idleLock);
+        this->stopping = true;
+    }
+    this->wake.notify_all();
+    for (std::thread& thread : this->threads)
+    {
+        thread.join();
+    }
+}
+
+unsigned ThreadPool::defaultWorkers()
+{
+    unsigned cores = std::thread::hardware_concurrency();
+    return cores > 1 ? cores - 1 : 0;
+}
+
+// workers own the first queues, everyone else shares the last
+unsigned ThreadPool::self() const
+{
+    return current_pool == this ? current_queue : this->queues.size() - 1;
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    Queue& queue = *this->queues[this->self()];
+    {
+        std::lock_guard<std::mutex> guard(queue.lock);
+        queue.tasks.push_back(std::move(task));
+    }
+    this->queued++;
+    {
+        std::lock_guard<std::mutex> guard(this->idleLock);
+    }
+    this->wake.notify_one();
+}
+
+bool ThreadPool::runOne()
+{
+    if (this->queued == 0)
+    {
+        return false;
+    }
+    unsigned index = this->self();
+    std::function<void()> task;
+    // newest of our own first, it is the most likely to be in cache
+    {
+        Queue& own = *this->queues[index];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.tasks.empty())
+        {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+        }
+    }
+    // then the oldest of someone else's
+    for (size_t i = 1; !task && i < this->queues.size(); i++)
+    {
+        Queue& victim = *this->queues[(index + i) % this->queues.size()];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+        }
+    }
+    if (!task)
+    {
+        return false;
+    }
+    this->queued--;
+    task();
+    return true;
+}
+
+void ThreadPool::work(unsigned index)
+{
+    current_pool = this;
+    current_queue = index;
+    while (true)
+    {
+        if (this->runOne())
+        {
+            continue;
+        }
+        std::unique_lock<std::mutex> guard(this->idleLock);
+        this->wake.wait(guard, [this] { return this->stopping || this->queued > 0; });
+        if (this->stopping)
+        {
+            return;
+        }
+    }
+}
+
+TaskGroup::~TaskGroup()
+{
+    // tasks refer to the group, so it cannot go away before them
+    while (this->pending > 0)
+    {
+        if (!this->pool.runOne())
+        {
+            std::this_thread::yield();
+        }
+    }
+    std::lock_guard<std::mutex> guard(this->lock); // the last task is done with it too
+}
+
+void TaskGroup::run(std::function<void()> task)
+{
+    this->pending++;
+    this->pool.submit([this, task = std::move(task)]
+    {
+        try
+        {
+            task();
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> guard(this->lock);
+            if (!this->error)
+            {
+                this->error = std::current_exception();
+            }
+        }
+        std::lock_guard<std::mutex> guard(this->lock);
+        if (--this->pending == 0)
+        {
+            this->finished.notify_all();
+        }
+    });
+}
+
+void TaskGroup::wait()
+{
+    while (this->pending > 0)
+    {
+        if (this->pool.runOne())
+        {
+            continue;
+        }
+        // the rest are running elsewhere, check back in case they queue more
+        std::unique_lock<std::mutex> guard(this->lock);
+        this->finished.wait_for(guard, std::chrono::milliseconds(1), [this] { return this->pending == 0; });
+    }
+    std::lock_guard<std::mutex> guard(this->lock);
+    if (this->error)
+    {
+        std::exception_ptr error = this->error;
+        this->error = nullptr;
+        std::rethrow_exception(error);
+    }
+}
@@ -0,0 +1,74 @@
+#include "includes/range.hpp"
+#include "includes/ast.hpp"
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+// one more than the largest uint64_t, the first double too large for one
+static const double uint64_end = 18446744073709551616.0;
+
+// how many steps from from to to, without overflowing where the distance
+// is more than a double holds but the steps are not
+static double steps_between(double from, double to, double step)
+{
+    double distance = to - from;
+    return std::isfinite(distance) ? distance / step : to / step - from / step;
+}
+
+std::optional<Range> Range::make(double start, double step, double stop)
+{
+    if (step == 0 || !std::isfinite(start) || !std::isfinite(step) || !std::isfinite(stop))
+    {
+        return std::nullopt;
+    }
+    double steps = std::floor(steps_between(start, stop, step) + tolerance);
+    if (steps < 0)
+    {
+        return Range(start, step, 0);
+    }
+    if (!(steps < uint64_end))
+    {
+        return std::nullopt; // more numbers than can be counted
+    }
+    return Range(start, step, (uint64_t)steps + 1);
+}
+
+bool Range::contains(double value) const
+{
+    if (this->count == 0)
+    {
+        return false;
+    }
+    double steps = steps_between(this->first, value, this->step);
+    double index = std::round(steps);
+    // compared as integers, a count past 2^53 is not exact as a double
+    return index >= 0 && index < uint64_end && (uint64_t)index < this->count && std::fabs(steps - index) <= tolerance;
+}
+
+std::optional<Range> constantRange(const Generator& generator)
+{
+    if (generator.start->kind != NodeKind::NumericLiteral || generator.step->kind != NodeKind::NumericLiteral || generator.stop->kind != NodeKind::NumericLiteral)
+    {
+        return std::nullopt;
+    }
+    return Range::make(static_cast<NumericLiteral*>(generator.start)->value,
+                       static_cast<NumericLiteral*>(generator.step)->value,
+                       static_cast<NumericLiteral*>(generator.stop)->value);
+}
+
+Set* materialise(const Range& range, Arena& arena, Span span)
+{
+    if (range.size() > UINT32_MAX)
+    {
+        throw std::runtime_error("Range of " + std::to_string(range.size()) + " numbers is too long to store");
+    }
+    uint32_t count = (uint32_t)range.size();
+    double* elements = count == 0 ? nullptr : (double*)arena.allocate(sizeof(double) * count, alignof(double));
+    bool integral = true;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        elements[i] = range[i];
+        integral = integral && elements[i] == std::floor(elements[i]);
+    }
+    return arena.make<Set>(ArenaArray<double>(elements, count), integral ? TypeDef::Tint64 : TypeDef::Tfloat64, span);
+}
@@ -0,0 +1,247 @@
+#include "includes/scan.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+using scan_detail::is_alpha;
+using scan_detail::is_digit;
+using scan_detail::is_blank;
+
+namespace
+{
+    struct Kernels
+    {
+        const char* (*alpha)(const char*, const char*);
+        const char* (*digits)(const char*, const char*);
+        const char* (*blanks)(const char*, const char*);
+        const char* (*until)(const char*, const char*, char);
+        const char* name;
+    };
+
+    // scalar
+
+    template <bool (*match)(char)>
+    inline const char* run_scalar(const char* p, const char* end)
+    {
+        while (p < end && match(*p)) p++;
+        return p;
+    }
+
+    const char* alpha_scalar(const char* p, const char* end)
+    {
+        return run_scalar<is_alpha>(p, end);
+    }
+
+    const char* digits_scalar(const char* p, const char* end)
+    {
+        return run_scalar<is_digit>(p, end);
+    }
+
+    const char* blanks_scalar(const char* p, const char* end)
+    {
+        return run_scalar<is_blank>(p, end);
+    }
+
+    const char* until_scalar(const char* p, const char* end, char c)
+    {
+        while (p < end && *p != c) p++;
+        return p;
+    }
+
+#ifdef SCAN_X86
+
+    // SSE2 only has signed byte compares, so a range check [lo, lo + n) is done
+    // by shifting lo down to -128 and comparing against -128 + n.
+
+    inline __m128i in_range_sse2(__m128i v, char lo, char n)
+    {
+        __m128i shifted = _mm_sub_epi8(v, _mm_set1_epi8((char)(lo + 128)));
+        return _mm_cmplt_epi8(shifted, _mm_set1_epi8((char)(-128 + n)));
+    }
+
+    inline __m128i alpha_mask_sse2(__m128i v)
+    {
+        return in_range_sse2(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 26);
+    }
+
+    inline __m128i digits_mask_sse2(__m128i v)
+    {
+        return in_range_sse2(v, '0', 10);
+    }
+
+    inline __m128i blanks_mask_sse2(__m128i v)
+    {
+        return _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t')));
+    }
+
+    // stops at the first byte of a block the mask does not match, what is left
+    // after the last whole block is finished a byte at a time
+    template <__m128i (*match)(__m128i), bool (*scalar)(char)>
+    inline const char* run_sse2(const char* p, const char* end)
+    {
+        for (; p + 16 <= end; p += 16)
+        {
+            unsigned mask = ~(unsigned)_mm_movemask_epi8(match(_mm_loadu_si128((const __m128i*)p))) & 0xFFFF;
+            if (mask)
+            {
+                return p + __builtin_ctz(mask);
+            }
+        }
+        return run_scalar<scalar>(p, end);
+    }
+
+    const char* alpha_sse2(const char* p, const char* end)
+    {
+        return run_sse2<alpha_mask_sse2, is_alpha>(p, end);
+    }
+
+    const char* digits_sse2(const char* p, const char* end)
+    {
+        return run_sse2<digits_mask_sse2, is_digit>(p, end);
+    }
+
+    const char* blanks_sse2(const char* p, const char* end)
+    {
+        return run_sse2<blanks_mask_sse2, is_blank>(p, end);
+    }
+
+    const char* until_sse2(const char* p, const char* end, char c)
+    {
+        __m128i needle = _mm_set1_epi8(c);
+        for (; p + 16 <= end; p += 16)
+        {
+            unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)p), needle));
+            if (mask)
+            {
+                return p + __builtin_ctz(mask);
+            }
+        }
+        while (p < end && *p != c) p++;
+        return p;
+    }
+
+    // AVX2, compiled for that target only so the rest of the file stays
+    // baseline. The tails stay inside these functions so no legacy SSE code
+    // runs while the upper halves of the registers are dirty.
+
+#define AVX2 __attribute__((target("avx2")))
+
+    AVX2 inline __m256i in_range_avx2(__m256i v, char lo, char n)
+    {
+        __m256i shifted = _mm256_sub_epi8(v, _mm256_set1_epi8((char)(lo + 128)));
+        return _mm256_cmpgt_epi8(_mm256_set1_epi8((char)(-128 + n)), shifted);
+    }
+
+    AVX2 inline __m256i alpha_mask_avx2(__m256i v)
+    {
+        return in_range_avx2(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 26);
+    }
+
+    AVX2 inline __m256i digits_mask_avx2(__m256i v)
+    {
+        return in_range_avx2(v, '0', 10);
+    }
+
+    AVX2 inline __m256i blanks_mask_avx2(__m256i v)
+    {
+        return _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t')));
+    }
+
+    template <__m256i (*match)(__m256i), bool (*scalar)(char)>
+    AVX2 inline const char* run_avx2(const char* p, const char* end)
+    {
+        for (; p + 32 <= end; p += 32)
+        {
+            unsigned mask = ~(unsigned)_mm256_movemask_epi8(match(_mm256_loadu_si256((const __m256i*)p)));
+            if (mask)
+            {
+                return p + __builtin_ctz(mask);
+            }
+        }
+        while (p < end && scalar(*p)) p++;
+        return p;
+    }
+
+    AVX2 const char* alpha_avx2(const char* p, const char* end)
+    {
+        return run_avx2<alpha_mask_avx2, is_alpha>(p, end);
+    }
+
+    AVX2 const char* digits_avx2(const char* p, const char* end)
+    {
+        return run_avx2<digits_mask_avx2, is_digit>(p, end);
+    }
+
+    AVX2 const char* blanks_avx2(const char* p, const char* end)
+    {
+        return run_avx2<blanks_mask_avx2, is_blank>(p, end);
+    }
+
+    AVX2 const char* until_avx2(const char* p, const char* end, char c)
+    {
+        __m256i needle = _mm256_set1_epi8(c);
+        for (; p + 32 <= end; p += 32)
+        {
+            unsigned mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)p), needle));
+            if (mask)
+            {
+                return p + __builtin_ctz(mask);
+            }
+        }
+        while (p < end && *p != c) p++;
+        return p;
+    }
+
+#undef AVX2
+
+#endif
+
+    Kernels select()
+    {
+#ifdef SCAN_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+        {
+            return {alpha_avx2, digits_avx2, blanks_avx2, until_avx2, "avx2"};
+        }
+        if (__builtin_cpu_supports("sse2"))
+        {
+            return {alpha_sse2, digits_sse2, blanks_sse2, until_sse2, "sse2"};
+        }
+#endif
+        return {alpha_scalar, digits_scalar, blanks_scalar, until_scalar, "scalar"};
+    }
+
+    // constant initialized, so anything scanning before startup has run the
+    // selection below still gets working (scalar) kernels
+    Kernels kernels = {alpha_scalar, digits_scalar, blanks_scalar, until_scalar, "scalar"};
+
+    const bool selected = (kernels = select(), true);
+}
+
+const char* scan_detail::alpha(const char* begin, const char* end)
+{
+    return kernels.alpha(begin, end);
+}
+
+const char* scan_detail::digits(const char* begin, const char* end)
+{
+    return kernels.digits(begin, end);
+}
+
+const char* scan_detail::blanks(const char* begin, const char* end)
+{
+    return kernels.blanks(begin, end);
+}
+
+const char* scan_detail::until(const char* begin, const char* end, char c)
+{
+    return kernels.until(begin, end, c);
+}
+
+const char* scan_implementation()
+{
+    return kernels.name;
+}
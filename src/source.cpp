@@ -0,0 +1,69 @@
+#include "includes/source.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+static void check_size(std::string_view content)
+{
+    if (content.size() >= max_source_size)
+    {
+        throw std::runtime_error("Source of " + std::to_string(content.size()) + " bytes is too large, inputs must be under 4 GiB");
+    }
+}
+
+Source::Source(std::string_view content)
+{
+    check_size(content);
+    this->content = content;
+}
+
+std::string_view Source::text(const Token& token) const
+{
+    if (token.length == 0)
+    {
+        // synthetic tokens have no text of their own
+        switch (token.type)
+        {
+            case TokenType::INDENT: return "INDENT";
+            case TokenType::DEDENT: return "DEDENT";
+            case TokenType::EoL: return "EOL";
+            case TokenType::EoF: return "EoF";
+            default: return "";
+        }
+    }
+    return this->content.substr(token.offset, token.length);
+}
+
+void Source::addLine(uint32_t offset)
+{
+    this->lines.push_back(offset);
+}
+
+int Source::replace(std::string_view content, uint32_t from, uint32_t to, const std::vector<uint32_t>& starts, int64_t delta)
+{
+    check_size(content);
+    this->content = content;
+    auto first = std::lower_bound(this->lines.begin(), this->lines.end(), from);
+    auto last = std::lower_bound(first, this->lines.end(), to);
+    int added = (int)starts.size() - (int)(last - first);
+    for (auto line = last; line != this->lines.end(); ++line)
+    {
+        *line += delta;
+    }
+    size_t index = first - this->lines.begin();
+    this->lines.erase(first, last);
+    this->lines.insert(this->lines.begin() + index, starts.begin(), starts.end());
+    return added;
+}
+
+// lines are numbered from 1 and columns from 0
+LineColumn Source::position(uint32_t offset) const
+{
+    auto line = std::upper_bound(this->lines.begin(), this->lines.end(), offset);
+    if (line == this->lines.begin())
+    {
+        return {1, (int)offset};
+    }
+    --line;
+    return {(int)(line - this->lines.begin()) + 1, (int)(offset - *line)};
+}
@@ -0,0 +1,115 @@
+#include "includes/stats.hpp"
+#include "includes/visitor.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include <sys/resource.h>
+
+static const char* phase_names[phase_count] = {"read", "cache", "lex", "parse", "fold", "output"};
+// what each phase's count is of
+static const char* count_names[phase_count] = {"", "hits", "tokens", "nodes", "removed", ""};
+
+static long peak_kb()
+{
+    struct rusage usage;
+    return getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss : 0;
+}
+
+void Stats::add(const Stats& other)
+{
+    for (size_t i = 0; i < phase_count; i++)
+    {
+        this->phases[i].runs += other.phases[i].runs;
+        this->phases[i].seconds += other.phases[i].seconds;
+        this->phases[i].count += other.phases[i].count;
+        this->phases[i].bytes += other.phases[i].bytes;
+        this->phases[i].peakKb = std::max(this->phases[i].peakKb, other.phases[i].peakKb);
+    }
+}
+
+void Stats::record(Phase phase, double seconds, uint64_t count, uint64_t bytes)
+{
+    PhaseStats& stats = (*this)[phase];
+    stats.runs++;
+    stats.seconds += seconds;
+    stats.count += count;
+    stats.bytes += bytes;
+    stats.peakKb = std::max(stats.peakKb, peak_kb());
+}
+
+void Stats::print(std::ostream& out, double wall) const
+{
+    char line[160];
+    snprintf(line, sizeof(line), "%-8s %6s %12s %20s %14s %12s\n", "phase", "runs", "time (ms)", "count", "bytes", "peak (MB)");
+    out << line;
+    for (size_t i = 0; i < phase_count; i++)
+    {
+        const PhaseStats& phase = this->phases[i];
+        if (phase.runs == 0)
+        {
+            continue;
+        }
+        char count[32] = "";
+        if (*count_names[i] != '\0')
+        {
+            snprintf(count, sizeof(count), "%llu %s", (unsigned long long)phase.count, count_names[i]);
+        }
+        snprintf(line, sizeof(line), "%-8s %6llu %12.3f %20s %14llu %12.1f\n", phase_names[i], (unsigned long long)phase.runs,
+                 phase.seconds * 1e3, count, (unsigned long long)phase.bytes, phase.peakKb / 1024.0);
+        out << line;
+    }
+    snprintf(line, sizeof(line), "%-8s %6s %12.3f %20s %14s %12.1f\n", "wall", "", wall * 1e3, "", "", peak_kb() / 1024.0);
+    out << line;
+}
+
+void Stats::toJSON(JsonWriter& out, double wall) const
+{
+    out.beginObject();
+    out.key("phases");
+    out.beginObject();
+    for (size_t i = 0; i < phase_count; i++)
+    {
+        const PhaseStats& phase = this->phases[i];
+        out.key(phase_names[i]);
+        out.beginObject();
+        out.key("runs");
+        out.number(phase.runs);
+        out.key("seconds");
+        out.number(phase.seconds);
+        if (*count_names[i] != '\0')
+        {
+            out.key(count_names[i]);
+            out.number(phase.count);
+        }
+        out.key("bytes");
+        out.number(phase.bytes);
+        out.key("peak_rss_kb");
+        out.number(phase.peakKb);
+        out.endObject();
+    }
+    out.endObject();
+    out.key("wall_seconds");
+    out.number(wall);
+    out.key("peak_rss_kb");
+    out.number(peak_kb());
+    out.endObject();
+}
+
+class NodeCounter : public Visitor<NodeCounter>
+{
+    public:
+        uint64_t count = 0;
+
+        void visitNode(Node* node)
+        {
+            this->count++;
+            this->visitChildren(node);
+        };
+};
+
+uint64_t countNodes(Node& root)
+{
+    NodeCounter counter;
+    counter.visit(&root);
+    return counter.count;
+}
@@ -0,0 +1,53 @@
+#include "includes/symbols.hpp"
+#include <functional>
+
+SymbolTable::SymbolTable()
+{
+    this->slots.resize(1024);
+    this->names.push_back({});
+    this->hashes.push_back(std::hash<std::string_view>()({}));
+    this->insert(0);
+}
+
+Symbol SymbolTable::intern(std::string_view name)
+{
+    uint32_t hash = std::hash<std::string_view>()(name);
+    std::lock_guard<std::mutex> guard(this->lock);
+    size_t mask = this->slots.size() - 1;
+    for (size_t i = hash & mask; this->slots[i] != 0; i = (i + 1) & mask)
+    {
+        uint32_t id = this->slots[i] - 1;
+        if (this->hashes[id] == hash && this->names[id] == name)
+        {
+            return {id};
+        }
+    }
+    uint32_t id = this->names.size();
+    this->names.push_back(this->arena.string(name));
+    this->hashes.push_back(hash);
+    if (this->names.size() * 2 > this->slots.size())
+    {
+        std::vector<uint32_t> old = std::move(this->slots);
+        this->slots.assign(old.size() * 2, 0);
+        for (uint32_t slot : old)
+        {
+            if (slot != 0)
+            {
+                this->insert(slot - 1);
+            }
+        }
+    }
+    this->insert(id);
+    return {id};
+}
+
+void SymbolTable::insert(uint32_t id)
+{
+    size_t mask = this->slots.size() - 1;
+    size_t i = this->hashes[id] & mask;
+    while (this->slots[i] != 0)
+    {
+        i = (i + 1) & mask;
+    }
+    this->slots[i] = id + 1;
+}
@@ -0,0 +1,198 @@
+// A Document edited piece by piece must end up with what lexing and parsing
+// its whole text from scratch gives: the same tokens, line table and tree,
+// spans included, or an error wherever a full parse has one. Makes random
+// edits, most of them undone by the next one, and compares after each.
+// Exits with 1 when any edit differs.
+// g++ -std=c++17 -O2 src/tests/document_edits.cpp src/document.cpp src/parser.cpp src/lexer.cpp src/source.cpp src/scan.cpp src/arena.cpp src/json.cpp src/flat_ast.cpp src/ast.cpp src/symbols.cpp src/token_stream.cpp src/pool.cpp -o document_edits -lpthread
+// ./document_edits [rounds] [seed]
+
+#include "../includes/document.hpp"
+#include "../includes/flat_ast.hpp"
+#include "../includes/json.hpp"
+#include "../includes/lexer.hpp"
+#include "../includes/parser.hpp"
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+
+const std::string program =
+    "add(x: int, y: int) : int = x + y\n"
+    "\n"
+    "fibonacci(x : int)\n"
+    "    if x <= 1\n"
+    "        return n\n"
+    "    else\n"
+    "        return add(fibonacci(n-1), fibonacci(n-2))\n"
+    "\n"
+    "xs = [fibonacci(x) for x in [1, 2..10]]\n"
+    "for i in [1..10]\n"
+    "    total = total + i\n"
+    "    while total > 100\n"
+    "        total = total - 7\n"
+    "ys = [y * 2 for y in xs if y > 3]\n"
+    "name = \"done\"\n";
+
+const std::vector<std::string> snippets = {
+    "x", "1", "\n", "    ", " ", "\nfoo = 2\n", "a", "(", ")", "\n    y = 3\n",
+    "if a > 1\n    b = 2\nelse\n    b = 3\n", ":", "[1, 2]", "+", "\t", "",
+};
+
+// every node's kind and span, then the tree as JSON
+static std::string describe(Program& program)
+{
+    FlatAst flat = FlatAst(program);
+    std::ostringstream out;
+    for (uint32_t i = 0; i < flat.size(); i++)
+    {
+        Span span = flat.spans[i];
+        out << (int)flat.kinds[i] << ":" << span.start.line << "," << span.start.column << "-" << span.end.line << "," << span.end.column << " ";
+    }
+    JsonWriter json = JsonWriter(false);
+    program.toJSON(json);
+    return out.str() + json.str();
+}
+
+// what is wrong with the document compared to parsing text whole, or nothing
+static std::string compare(const Document& document, const std::string& text)
+{
+    if (document.text() != text)
+    {
+        return "text differs";
+    }
+    Source source = Source(text);
+    std::vector<Token> tokens;
+    std::unique_ptr<Program> program;
+    std::string error;
+    try
+    {
+        Lexer lexer = Lexer(source);
+        tokens = lexer.init();
+        Parser parser = Parser(tokens, source);
+        program = parser.parse();
+    }
+    catch (const std::exception& e)
+    {
+        error = e.what();
+    }
+    if (!error.empty() || !document.errors().empty())
+    {
+        if (error.empty())
+        {
+            return "spurious error " + document.errors()[0];
+        }
+        return document.errors().empty() ? "missed error " + error : "";
+    }
+    const std::vector<Token>& edited = document.tokens();
+    if (edited.size() != tokens.size())
+    {
+        return "token counts differ";
+    }
+    for (size_t i = 0; i < tokens.size(); i++)
+    {
+        if (edited[i].offset != tokens[i].offset || edited[i].length != tokens[i].length || edited[i].type != tokens[i].type)
+        {
+            return "token " + std::to_string(i) + " differs";
+        }
+        LineColumn a = document.source().position(tokens[i]);
+        LineColumn b = source.position(tokens[i]);
+        if (a.line != b.line || a.column != b.column)
+        {
+            return "position of token " + std::to_string(i) + " differs";
+        }
+    }
+    if (document.source().lineCount() != source.lineCount())
+    {
+        return "line counts differ";
+    }
+    if (describe(document.program()) != describe(*program))
+    {
+        return "trees differ";
+    }
+    return "";
+}
+
+int main(int argc, char** argv)
+{
+    int rounds = argc > 1 ? std::stoi(argv[1]) : 2000;
+    std::mt19937 random = std::mt19937(argc > 2 ? std::stoi(argv[2]) : 1);
+    std::string text = program;
+    Document document = Document(text);
+    // the edit that takes back the last insertion, made next
+    bool undo = false;
+    size_t undoOffset = 0;
+    size_t undoLength = 0;
+    std::string undoText;
+    int failures = 0;
+    int errorRounds = 0;
+    for (int round = 0; round < rounds; round++)
+    {
+        size_t offset;
+        size_t length = 0;
+        std::string replacement;
+        int mode = random() % 4;
+        if (undo)
+        {
+            offset = undoOffset;
+            length = undoLength;
+            replacement = undoText;
+            undo = false;
+        }
+        else if (mode == 0 || text.empty())
+        {
+            // a snippet anywhere, sometimes over a few bytes
+            offset = random() % (text.size() + 1);
+            if (random() % 4 == 0)
+            {
+                length = random() % std::min<size_t>(40, text.size() - offset + 1);
+            }
+            replacement = snippets[random() % snippets.size()];
+            undo = true;
+            undoOffset = offset;
+            undoLength = replacement.size();
+            undoText = text.substr(offset, length);
+        }
+        else if (mode == 1)
+        {
+            // a digit changed, which keeps the text parsing
+            size_t digit = text.find_first_of("0123456789", random() % text.size());
+            if (digit == std::string::npos)
+            {
+                digit = text.find_first_of("0123456789");
+            }
+            if (digit == std::string::npos)
+            {
+                continue;
+            }
+            offset = digit;
+            length = 1;
+            replacement = std::string(1, '0' + random() % 10);
+        }
+        else
+        {
+            // a statement or blank lines added at a line start, indented like that line
+            size_t newline = text.rfind('\n', random() % text.size());
+            offset = newline == std::string::npos ? 0 : newline + 1;
+            size_t first = text.find_first_not_of(" \t", offset);
+            if (first == std::string::npos || text[first] == '\n' || text.compare(first, 4, "else") == 0)
+            {
+                continue;
+            }
+            replacement = mode == 2 ? text.substr(offset, first - offset) + "zz = 1\n" : "\n\n";
+        }
+        text.replace(offset, length, replacement);
+        document.edit(offset, length, replacement);
+        std::string problem = compare(document, text);
+        if (!problem.empty())
+        {
+            failures++;
+            std::cout << "round " << round << ": " << problem << std::endl;
+        }
+        if (!document.errors().empty())
+        {
+            errorRounds++;
+        }
+    }
+    std::cout << rounds << " edits, " << errorRounds << " leaving errors, " << failures << " differ" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+// Constant folding, checked statement by statement against the tree the
+// expected source parses to, and the number of nodes it says it removed.
+// Identities are only dropped around operands sure to be numbers, never
+// around names, calls or anything else that could hold a string.
+// Exits with 1 when any case differs.
+// g++ -std=c++17 -O2 src/tests/fold.cpp src/fold.cpp src/range.cpp src/parser.cpp src/lexer.cpp src/source.cpp src/scan.cpp src/arena.cpp src/json.cpp src/flat_ast.cpp src/ast.cpp src/symbols.cpp src/token_stream.cpp src/pool.cpp -o fold_test -lpthread
+
+#include "../includes/fold.hpp"
+#include "../includes/json.hpp"
+#include "../includes/lexer.hpp"
+#include "../includes/parser.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct Case
+{
+    std::string source;
+    std::string expected;
+    uint64_t removed;
+};
+
+const std::vector<Case> cases = {
+    // anything that is not surely a number keeps its identity
+    {"y = s + 0\n", "y = s + 0\n", 0},
+    {"y = 0 + s\n", "y = 0 + s\n", 0},
+    {"y = s - 0\n", "y = s - 0\n", 0},
+    {"y = s * 1\n", "y = s * 1\n", 0},
+    {"y = 1 * s\n", "y = 1 * s\n", 0},
+    {"y = s / 1\n", "y = s / 1\n", 0},
+    {"y = s ^ 1\n", "y = s ^ 1\n", 0},
+    {"y = f(x) + 0\n", "y = f(x) + 0\n", 0},
+    {"y = a.b * 1\n", "y = a.b * 1\n", 0},
+    {"y = \"a\" + 0\n", "y = \"a\" + 0\n", 0},
+    {"y = s + 1 - 1\n", "y = s + 1 - 1\n", 0},
+    // arithmetic over numbers that cannot fold is still a number
+    {"y = 1 / 0\n", "y = 1 / 0\n", 0},
+    {"y = 1 / 0 * 1\n", "y = 1 / 0\n", 2},
+    {"y = 0 + 1 / 0 - 0\n", "y = 1 / 0\n", 4},
+    {"y = 1 / 0 + s * 1\n", "y = 1 / 0 + s * 1\n", 0},
+    // constants
+    {"y = 1 + 2 * 3\n", "y = 7\n", 4},
+    {"y = 2 ^ 3 ^ 2\n", "y = 512\n", 4},
+    {"y = 7 - 2 - 1\n", "y = 4\n", 4},
+    {"y = 3 > 2\n", "y = true\n", 2},
+    {"y = 2 == 3\n", "y = false\n", 2},
+    {"y = true and false\n", "y = false\n", 2},
+    {"y = false or true\n", "y = true\n", 2},
+    {"y = 5 in [1, 2..10]\n", "y = true\n", 5},
+    {"y = 6 in [1, 2..10]\n", "y = false\n", 5},
+    {"y = 5 in [1, 1 + 1..5 * 2]\n", "y = true\n", 9},
+    {"y = x in [1..10]\n", "y = x in [1..10]\n", 0},
+    {"y = x not z\n", "y = x not z\n", 0},
+    {"f(fibonacci(n - 1 * 1))\n", "f(fibonacci(n - 1))\n", 2},
+};
+
+static std::unique_ptr<Program> parse(const std::string& text)
+{
+    Source source = Source(text);
+    Lexer lexer = Lexer(source);
+    Parser parser = Parser(lexer, source);
+    return parser.parse();
+}
+
+static std::string json(Program& program)
+{
+    JsonWriter out = JsonWriter(false);
+    program.toJSON(out);
+    return out.str();
+}
+
+int main()
+{
+    int failures = 0;
+    for (const Case& test : cases)
+    {
+        std::unique_ptr<Program> folded = parse(test.source);
+        uint64_t removed = foldConstants(*folded);
+        std::unique_ptr<Program> expected = parse(test.expected);
+        std::string got = json(*folded);
+        std::string want = json(*expected);
+        if (got != want || removed != test.removed)
+        {
+            failures++;
+            std::cout << "folding " << test.source << "  gave " << got << " removing " << removed << std::endl
+                      << "  not " << want << " removing " << test.removed << std::endl;
+        }
+    }
+    std::cout << cases.size() << " cases, " << failures << " failed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,163 @@
+// Lexing in chunks on a pool must give exactly the tokens, line table and
+// errors of a serial lex. Cuts every input at each newline and at each pair
+// of newlines, so chunks start inside indented blocks, between a block and
+// its dedents, on blank and comment lines, and on the lines of strings left
+// open at a line's end. Exits with 1 when any cut differs.
+// g++ -std=c++17 -O2 src/tests/lexer_chunks.cpp src/lexer.cpp src/source.cpp src/scan.cpp src/pool.cpp -o lexer_chunks -lpthread
+
+#include "../includes/lexer.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+const std::vector<std::string> inputs = {
+    "add(x: int, y: int) : int = x + y\n"
+    "\n"
+    "fibonacci(x : int)\n"
+    "    if x <= 1\n"
+    "        return n\n"
+    "    else\n"
+    "        return add(fibonacci(n-1), fibonacci(n-2))\n"
+    "\n"
+    "xs = [fibonacci(x) for x in [1, 2..10]]",
+    // blank, whitespace-only and comment lines inside and between blocks
+    "f(x)\n"
+    "    a = 1\n"
+    "\n"
+    "        \n"
+    "    # a comment further out\n"
+    "  # and one that is not indented to the block\n"
+    "    while a < 10\n"
+    "        a = a + 1\n"
+    "\n"
+    "            # deeper\n"
+    "        b = a\n"
+    "g = 2\n",
+    // several blocks closed at once, and at the very end of the input
+    "a\n"
+    "    b\n"
+    "        c\n"
+    "            d\n"
+    "e\n"
+    "    f\n"
+    "        g\n"
+    "            h\n",
+    // tabs and spaces measuring to the same width
+    "if x\n"
+    "\ty = 1\n"
+    "    z = 2\n"
+    "\tif y\n"
+    "\t    w = 3\n"
+    "done\n",
+    // strings the line ends before they close, and ones that hold a quote
+    "s = \"open to the end of the line\n"
+    "    t = 'still open\n"
+    "    u = \"it's closed\"\n"
+    "v = 'a \"quoted\" word'\n"
+    "w = \"\n"
+    "\"\n",
+    // a dedent to a width no open block has
+    "if x\n"
+    "        y = 1\n"
+    "    z = 2\n"
+    "w = 3\n",
+    "\n\n\n",
+    "x = 1\n",
+};
+
+struct Result
+{
+    std::vector<Token> tokens;
+    std::vector<LineColumn> positions;
+    int lines = 0;
+    std::string error;
+};
+
+static Result lex(const std::string& text, ThreadPool* pool, const std::vector<size_t>& cuts)
+{
+    Result result;
+    Source source = Source(text);
+    Lexer lexer = Lexer(source);
+    try
+    {
+        result.tokens = pool == nullptr ? lexer.init() : lexer.init(*pool, cuts);
+    }
+    catch (const std::exception& e)
+    {
+        result.error = e.what();
+        return result;
+    }
+    for (const Token& token : result.tokens)
+    {
+        result.positions.push_back(source.position(token));
+    }
+    result.lines = source.lineCount();
+    return result;
+}
+
+static bool same(const Result& a, const Result& b)
+{
+    if (a.error != b.error || a.lines != b.lines || a.tokens.size() != b.tokens.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < a.tokens.size(); i++)
+    {
+        const Token& x = a.tokens[i];
+        const Token& y = b.tokens[i];
+        if (x.offset != y.offset || x.length != y.length || x.type != y.type)
+        {
+            return false;
+        }
+        if (a.positions[i].line != b.positions[i].line || a.positions[i].column != b.positions[i].column)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main()
+{
+    ThreadPool pool = ThreadPool(3);
+    int failures = 0;
+    size_t checked = 0;
+    for (size_t n = 0; n < inputs.size(); n++)
+    {
+        const std::string& text = inputs[n];
+        Result serial = lex(text, nullptr, {});
+        std::vector<size_t> newlines;
+        for (size_t i = 0; i + 1 < text.size(); i++)
+        {
+            if (text[i] == '\n')
+            {
+                newlines.push_back(i + 1);
+            }
+        }
+        std::vector<std::vector<size_t>> cutsets = {{}, newlines};
+        for (size_t i = 0; i < newlines.size(); i++)
+        {
+            cutsets.push_back({newlines[i]});
+            for (size_t j = i + 1; j < newlines.size(); j++)
+            {
+                cutsets.push_back({newlines[i], newlines[j]});
+            }
+        }
+        for (const std::vector<size_t>& cuts : cutsets)
+        {
+            checked++;
+            if (!same(serial, lex(text, &pool, cuts)))
+            {
+                failures++;
+                std::cout << "input " << n << " differs when cut at";
+                for (size_t cut : cuts)
+                {
+                    std::cout << " " << cut;
+                }
+                std::cout << std::endl;
+            }
+        }
+    }
+    std::cout << checked << " cuts, " << failures << " differ" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,152 @@
+// The closed forms of Range, which folding uses for membership in a
+// generator, checked on the edges: steps that are negative, zero or not
+// exact in binary, ranges that are empty or hold one number, and bounds
+// near the limits of a double. Then indexing, iterating and materialising
+// the same ranges, and folding giving the generators that loops and
+// comprehensions iterate their range. Exits with 1 when any check fails.
+// g++ -std=c++17 -O2 src/tests/range.cpp src/range.cpp src/fold.cpp src/parser.cpp src/lexer.cpp src/source.cpp src/scan.cpp src/arena.cpp src/json.cpp src/flat_ast.cpp src/ast.cpp src/symbols.cpp src/token_stream.cpp src/pool.cpp -o range_test -lpthread
+
+#include "../includes/fold.hpp"
+#include "../includes/lexer.hpp"
+#include "../includes/parser.hpp"
+#include "../includes/range.hpp"
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+static int failures = 0;
+
+static void check(bool ok, const char* what)
+{
+    if (!ok)
+    {
+        failures++;
+        std::cout << "failed: " << what << std::endl;
+    }
+}
+
+// every number of the range, by iterating it
+static std::vector<double> numbers(const Range& range)
+{
+    std::vector<double> result;
+    for (double number : range)
+    {
+        result.push_back(number);
+    }
+    return result;
+}
+
+// the generator the first statement iterates, after folding, which is a for
+// loop or an assignment of a comprehension
+static Generator* iterated(Program& program)
+{
+    foldConstants(program);
+    Statement* statement = program.program[0];
+    Value* iterable = nullptr;
+    if (statement->kind == NodeKind::ForLoop)
+    {
+        iterable = static_cast<ForLoop*>(statement)->iterable;
+    }
+    else if (statement->kind == NodeKind::Assignment)
+    {
+        Expression* rhs = static_cast<Assignment*>(statement)->rhs;
+        if (rhs->kind == NodeKind::ListComprehension)
+        {
+            iterable = static_cast<ListComprehension*>(rhs)->iterable;
+        }
+    }
+    return iterable != nullptr && iterable->kind == NodeKind::Generator ? static_cast<Generator*>(iterable) : nullptr;
+}
+
+static std::unique_ptr<Program> parse(const std::string& text)
+{
+    Source source = Source(text);
+    Lexer lexer = Lexer(source);
+    Parser parser = Parser(lexer, source);
+    return parser.parse();
+}
+
+int main()
+{
+    const double infinity = std::numeric_limits<double>::infinity();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double largest = std::numeric_limits<double>::max();
+
+    std::optional<Range> ten = Range::make(1, 1, 10);
+    check(ten && ten->size() == 10, "[1..10] has ten numbers");
+    check(ten->contains(1) && ten->contains(10) && ten->contains(5), "[1..10] holds its ends and middle");
+    check(!ten->contains(0) && !ten->contains(11) && !ten->contains(5.5), "[1..10] holds nothing else");
+
+    std::optional<Range> odd = Range::make(1, 2, 10);
+    check(odd && odd->size() == 5, "[1, 2..10] stops short of 10");
+    check(odd->contains(9) && !odd->contains(10) && !odd->contains(2), "[1, 2..10] holds only its steps");
+
+    std::optional<Range> down = Range::make(10, -3, 0);
+    check(down && down->size() == 4, "counting down by 3 from 10 to 0 has four numbers");
+    check(down->contains(1) && down->contains(10) && !down->contains(-2) && !down->contains(13), "counting down holds 10, 7, 4, 1");
+
+    std::optional<Range> empty = Range::make(5, 1, 4);
+    check(empty && empty->size() == 0 && !empty->contains(5) && !empty->contains(4), "a range stopping before it starts is empty");
+    std::optional<Range> wrongWay = Range::make(0, -1, 5);
+    check(wrongWay && wrongWay->size() == 0, "stepping away from stop is empty");
+
+    std::optional<Range> one = Range::make(3, 7, 3);
+    check(one && one->size() == 1 && one->contains(3) && !one->contains(10), "a range starting at stop holds just that");
+
+    check(!Range::make(1, 0, 10), "a step of zero is no range");
+    check(!Range::make(1, nan, 10) && !Range::make(nan, 1, 10) && !Range::make(1, 1, nan), "NaN gives no range");
+    check(!Range::make(1, infinity, 10) && !Range::make(-infinity, 1, 0) && !Range::make(0, 1, infinity), "infinities give no range");
+
+    std::optional<Range> tenths = Range::make(0, 0.1, 0.3);
+    check(tenths && tenths->size() == 4, "[0, 0.1..0.3] reaches 0.3 despite rounding");
+    check(tenths->contains(0.3) && tenths->contains(0.1 + 0.2) && !tenths->contains(0.35), "tenths hold their steps give or take rounding");
+
+    std::optional<Range> huge = Range::make(0, 1, 1e19);
+    check(huge && huge->size() == (uint64_t)1e19 + 1, "a range of 1e19 steps is counted exactly");
+    check(huge->contains(1e19) && !huge->contains(-1) && !huge->contains(2e19), "a huge range holds its end and not past it");
+
+    check(!Range::make(0, 1, 1e20), "more numbers than 64 bits can count give no range");
+    check(!Range::make(-largest, 1, largest), "a span of more steps than 64 bits can count gives no range");
+    std::optional<Range> wide = Range::make(-largest, largest, largest);
+    check(wide && wide->size() == 3 && wide->contains(largest) && wide->contains(0), "a span that overflows a double counts in steps that do not");
+
+    check(!ten->contains(nan) && !ten->contains(infinity) && !ten->contains(-infinity), "no range holds NaN or an infinity");
+    std::optional<Range> fine = Range::make(0, 1e-300, 1e-299);
+    check(fine && fine->size() == 11 && !fine->contains(largest), "a value past a tiny step's reach is not held");
+
+    check(!ten->empty() && !one->empty() && empty->empty() && wrongWay->empty(), "only ranges without numbers are empty");
+    check((*ten)[0] == 1 && (*ten)[9] == 10 && (*odd)[4] == 9 && (*down)[3] == 1, "indexing gives each step from the first number");
+    check((*huge)[(uint64_t)1e19] == 1e19, "indexing a huge range reaches its end");
+    check(numbers(*odd) == std::vector<double>({1, 3, 5, 7, 9}), "iterating [1, 2..10] gives its odd numbers");
+    check(numbers(*down) == std::vector<double>({10, 7, 4, 1}), "iterating a range counting down goes down");
+    check(numbers(*empty).empty() && numbers(*one) == std::vector<double>({3}), "iterating empty and one number ranges");
+    std::vector<double> steps = numbers(*tenths);
+    check(steps.size() == 4 && std::fabs(steps[3] - 0.3) < Range::tolerance, "iterating tenths ends at 0.3 give or take rounding");
+
+    Arena arena;
+    Set* odds = materialise(*odd, arena, Span());
+    check(odds->kind == NodeKind::Set && odds->Type == TypeDef::Tint64 && odds->elements.size() == 5, "materialising [1, 2..10] gives a set of five ints");
+    check(odds->elements[0] == 1 && odds->elements[4] == 9, "a materialised set holds the range's numbers in order");
+    Set* floats = materialise(*tenths, arena, Span());
+    check(floats->Type == TypeDef::Tfloat64 && floats->elements.size() == 4, "materialising tenths gives a set of floats");
+    check(materialise(*empty, arena, Span())->elements.empty(), "materialising an empty range gives an empty set");
+
+    std::unique_ptr<Program> loop = parse("for i in [1, 2..10]\n    print(i)\n");
+    Generator* looped = iterated(*loop);
+    check(looped && looped->range && looped->range->size() == 5 && (*looped->range)[4] == 9, "a for loop's literal generator gets its range");
+    std::unique_ptr<Program> comprehension = parse("xs = [x * 2 for x in [1, 1 + 1..5 * 2]]\n");
+    Generator* comprehended = iterated(*comprehension);
+    check(comprehended && comprehended->range && comprehended->range->size() == 5, "a comprehension's generator gets its range once its bounds fold");
+    std::unique_ptr<Program> open = parse("for i in [1..n]\n    print(i)\n");
+    Generator* unbounded = iterated(*open);
+    check(unbounded && !unbounded->range, "a generator with a name for a bound gets no range");
+    std::unique_ptr<Program> assigned = parse("xs = [1..10]\n");
+    foldConstants(*assigned);
+    Expression* rhs = static_cast<Assignment*>(assigned->program[0])->rhs;
+    check(rhs->kind == NodeKind::Generator && !static_cast<Generator*>(rhs)->range, "a generator nothing iterates is left as it is");
+
+    std::cout << (failures == 0 ? "all passed" : "some failed") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,149 @@
+#include "includes/token_stream.hpp"
+#include <algorithm>
+
+// tokens pulled at a time, and the ring's starting size
+static const size_t batch = 64;
+static const size_t initial_ring = 256;
+
+TokenStream::TokenStream(std::vector<Token> tokens) : tokens(std::move(tokens))
+{
+    this->ring.resize(initial_ring);
+    this->brackets.resize(initial_ring);
+    this->mask = initial_ring - 1;
+    this->head = 0;
+    this->tail = 0;
+    this->next = 0;
+    this->lexer = nullptr;
+    this->exhausted = false;
+    this->last = {0, 0, TokenType::EoF};
+}
+
+TokenStream::TokenStream(Lexer& lexer) : TokenStream(std::vector<Token>())
+{
+    this->lexer = &lexer;
+}
+
+void TokenStream::fill(size_t count)
+{
+    while (this->tail - this->head < count)
+    {
+        this->pull();
+    }
+}
+
+void TokenStream::pull()
+{
+    if (this->exhausted)
+    {
+        this->push(this->last);
+        return;
+    }
+    size_t before = this->tail;
+    if (this->lexer != nullptr)
+    {
+        for (const Token& token : this->lexer->next(batch))
+        {
+            this->push(token);
+        }
+    }
+    else
+    {
+        size_t end = std::min(this->tokens.size(), this->next + batch);
+        for (; this->next < end; this->next++)
+        {
+            this->push(this->tokens[this->next]);
+        }
+    }
+    if (this->tail == before)
+    {
+        // input that did not end in EoF
+        this->exhausted = true;
+        this->push(this->last);
+    }
+}
+
+void TokenStream::push(const Token& token)
+{
+    if (this->tail - this->head == this->ring.size())
+    {
+        this->grow();
+    }
+    size_t at = this->tail++;
+    this->ring[at & this->mask] = token;
+    this->brackets[at & this->mask] = {unmatched, TokenType::ID};
+    // brackets whose opening token has been read past are no longer asked about
+    switch (token.type)
+    {
+        case TokenType::LPAREN:
+        case TokenType::LSQUARE:
+            this->open.push_back({at, token.type});
+            break;
+        case TokenType::RPAREN:
+        case TokenType::RSQUARE:
+        {
+            TokenType opener = token.type == TokenType::RPAREN ? TokenType::LPAREN : TokenType::LSQUARE;
+            if (!this->open.empty() && this->open.back().type == opener)
+            {
+                if (this->open.back().index >= this->head)
+                {
+                    this->brackets[this->open.back().index & this->mask].close = at;
+                }
+                this->open.pop_back();
+            }
+            break;
+        }
+        case TokenType::FOR:
+        case TokenType::ELIPSIS:
+            if (!this->open.empty() && this->open.back().type == TokenType::LSQUARE && this->open.back().index >= this->head)
+            {
+                // a comprehension wins over a range inside it
+                TokenType& form = this->brackets[this->open.back().index & this->mask].form;
+                if (form != TokenType::FOR)
+                {
+                    form = token.type;
+                }
+            }
+            break;
+        case TokenType::EoF:
+            this->exhausted = true;
+            this->last = token;
+            break;
+        default:
+            break;
+    }
+}
+
+void TokenStream::grow()
+{
+    size_t size = this->ring.size() * 2;
+    std::vector<Token> ring(size);
+    std::vector<Bracket> brackets(size);
+    for (size_t i = this->head; i < this->tail; i++)
+    {
+        ring[i & (size - 1)] = this->ring[i & this->mask];
+        brackets[i & (size - 1)] = this->brackets[i & this->mask];
+    }
+    this->ring = std::move(ring);
+    this->brackets = std::move(brackets);
+    this->mask = size - 1;
+}
+
+const TokenStream::Bracket& TokenStream::bracket(size_t ahead)
+{
+    TokenType type = this->peek(ahead).type;
+    size_t at = this->head + ahead;
+    if (type == TokenType::LPAREN || type == TokenType::LSQUARE)
+    {
+        while (this->brackets[at & this->mask].close == unmatched && !this->exhausted)
+        {
+            this->pull();
+        }
+    }
+    return this->brackets[at & this->mask];
+}
+
+size_t TokenStream::closing(size_t ahead)
+{
+    size_t close = this->bracket(ahead).close;
+    return close == unmatched ? unmatched : close - this->head;
+}